@@ -0,0 +1,185 @@
+/*
+	Import time for a multi-million triangle model, everything loadObject does after Assimp has parsed the file:
+		legacy			the old processMesh, one push_back per vertex and per index with nothing reserved
+		processNode		the current bulk conversion into the object's vertex and index buffers
+		optimizeObject, packVertices, narrowIndices as loadObject runs them
+	The model is a grid of quads split into row strips, one mesh each, built straight into an aiScene so the file
+	parse (which depends on the format and Assimp's flags) is left out.
+
+	Not part of the engine build, from MirielEngine/ (the logger writes into Logs/, run it from a directory that has one),
+	linking assimp and nativefiledialog-extended the same way the engine does:
+		cl /std:c++20 /O2 /EHsc /Iinclude bench\ImportBench.cpp src\Scenes\ObjectLoader.cpp src\Scenes\MeshOptimizer.cpp
+			src\Scenes\MeshCache.cpp src\Scenes\InstanceStore.cpp src\Scenes\TransformHierarchy.cpp src\Utils\StringInterner.cpp
+			src\Utils\MonotonicArena.cpp src\Utils\JobSystem.cpp src\Utils\MirielEngineLogger.cpp src\Utils\MirielEngineLogFormat.cpp
+			src\Utils\MappedLogRing.cpp src\Utils\MappedFile.cpp src\Utils\LogCompressor.cpp assimp.lib nfd.lib
+	Optional arguments: quads along each side of the grid (default 1024, about 2.1M triangles) and the mesh count (default 8).
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <assimp/scene.h>
+
+#include "Scenes/ObjectLoader.hpp"
+#include "Scenes/MeshOptimizer.hpp"
+#include "Utils/JobSystem.hpp"
+#include "Utils/MirielEngineLogger.hpp"
+#include "Utils/StringInterner.hpp"
+
+MirielEngine::Utils::Logger* MirielEngine::Utils::Logger::instance = nullptr;
+std::mutex MirielEngine::Utils::Logger::mtx;
+MirielEngine::Utils::JobSystem* MirielEngine::Utils::JobSystem::instance = nullptr;
+std::mutex MirielEngine::Utils::JobSystem::mtx;
+MirielEngine::Utils::StringInterner* MirielEngine::Utils::StringInterner::instance = nullptr;
+std::mutex MirielEngine::Utils::StringInterner::mtx;
+
+namespace {
+	using namespace MirielEngine::Core;
+
+	// Rows of quads from firstRow up to lastRow, with their own copy of the vertices on the shared edges like an exporter would write them
+	aiMesh* makeStrip(unsigned side, unsigned firstRow, unsigned lastRow) {
+		unsigned rows = lastRow - firstRow;
+		aiMesh* mesh = new aiMesh();
+		mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+		mesh->mNumVertices = (rows + 1) * (side + 1);
+		mesh->mVertices = new aiVector3D[mesh->mNumVertices];
+		mesh->mNormals = new aiVector3D[mesh->mNumVertices];
+		mesh->mTextureCoords[0] = new aiVector3D[mesh->mNumVertices];
+		for (unsigned y = 0; y <= rows; y++) {
+			for (unsigned x = 0; x <= side; x++) {
+				unsigned i = y * (side + 1) + x;
+				float u = static_cast<float>(x) / side;
+				float v = static_cast<float>(firstRow + y) / side;
+				mesh->mVertices[i] = aiVector3D(u * 100.0f, 0.0f, v * 100.0f);
+				mesh->mNormals[i] = aiVector3D(0.0f, 1.0f, 0.0f);
+				mesh->mTextureCoords[0][i] = aiVector3D(u, v, 0.0f);
+			}
+		}
+
+		// Assimp gives every face its own index array, so the bench does too
+		mesh->mNumFaces = rows * side * 2;
+		mesh->mFaces = new aiFace[mesh->mNumFaces];
+		unsigned face = 0;
+		for (unsigned y = 0; y < rows; y++) {
+			for (unsigned x = 0; x < side; x++) {
+				unsigned corner = y * (side + 1) + x;
+				unsigned quad[2][3] = { { corner, corner + side + 1, corner + 1 }, { corner + 1, corner + side + 1, corner + side + 2 } };
+				for (const auto& triangle : quad) {
+					mesh->mFaces[face].mNumIndices = 3;
+					mesh->mFaces[face].mIndices = new unsigned[3]{ triangle[0], triangle[1], triangle[2] };
+					face++;
+				}
+			}
+		}
+		return mesh;
+	}
+
+	aiScene* makeGrid(unsigned side, unsigned meshCount) {
+		aiScene* scene = new aiScene();
+		scene->mNumMeshes = meshCount;
+		scene->mMeshes = new aiMesh*[meshCount];
+		for (unsigned i = 0; i < meshCount; i++) {
+			scene->mMeshes[i] = makeStrip(side, side * i / meshCount, side * (i + 1) / meshCount);
+		}
+		scene->mNumMaterials = 1;
+		scene->mMaterials = new aiMaterial*[1]{ new aiMaterial() };
+
+		scene->mRootNode = new aiNode();
+		scene->mRootNode->mTransformation = aiMatrix4x4{ 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+		scene->mRootNode->mNumMeshes = meshCount;
+		scene->mRootNode->mMeshes = new unsigned[meshCount];
+		for (unsigned i = 0; i < meshCount; i++) {
+			scene->mRootNode->mMeshes[i] = i;
+		}
+		return scene;
+	}
+
+	// processMesh before the bulk conversion, kept here only to compare against
+	void legacyProcessMesh(aiMesh* mesh, Object* object) {
+		for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
+			Vertex v{};
+			v.aPos = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
+			v.normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+
+			if (mesh->mTextureCoords[0]) {
+				v.texCoord = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+			}
+
+			v.color = glm::vec3(1.0f, 1.0f, 1.0f);
+			object->vertices.push_back(v);
+		}
+
+		for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+			aiFace face = mesh->mFaces[i];
+			for (unsigned int j = 0; j < face.mNumIndices; j++) {
+				object->indices.push_back(face.mIndices[j]);
+			}
+		}
+	}
+
+	double millisecondsSince(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+int main(int argc, char* argv[]) {
+	unsigned side = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 1024;
+	unsigned meshCount = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 8;
+
+	aiScene* scene = makeGrid(side, meshCount);
+	size_t triangles = 0;
+	size_t vertices = 0;
+	for (unsigned i = 0; i < scene->mNumMeshes; i++) {
+		triangles += scene->mMeshes[i]->mNumFaces;
+		vertices += scene->mMeshes[i]->mNumVertices;
+	}
+	std::printf("%zu triangles, %zu vertices in %u meshes\n", triangles, vertices, meshCount);
+
+	// Best of three, each run starts from a fresh object since the later stages rewrite it
+	double legacy = 1e30, convert = 1e30, optimize = 1e30, pack = 1e30, narrow = 1e30;
+	bool packed = false, narrowed = false;
+	for (int run = 0; run < 3; run++) {
+		{
+			Object object;
+			auto start = std::chrono::steady_clock::now();
+			for (unsigned i = 0; i < scene->mNumMeshes; i++) {
+				legacyProcessMesh(scene->mMeshes[i], &object);
+			}
+			legacy = std::min(legacy, millisecondsSince(start));
+		}
+
+		Object object;
+		auto start = std::chrono::steady_clock::now();
+		processNode(scene->mRootNode, scene, &object, TextureLoadFunction{});
+		convert = std::min(convert, millisecondsSince(start));
+
+		start = std::chrono::steady_clock::now();
+		optimizeObject(&object);
+		optimize = std::min(optimize, millisecondsSince(start));
+
+		start = std::chrono::steady_clock::now();
+		packed = packVertices(&object);
+		pack = std::min(pack, millisecondsSince(start));
+
+		start = std::chrono::steady_clock::now();
+		narrowed = narrowIndices(&object);
+		narrow = std::min(narrow, millisecondsSince(start));
+	}
+
+	auto report = [triangles](const char* stage, double milliseconds) {
+		std::printf("%-28s %9.1f ms  %6.1f ns/triangle\n", stage, milliseconds, milliseconds * 1e6 / triangles);
+	};
+	report("legacy", legacy);
+	report("processNode", convert);
+	report("optimizeObject", optimize);
+	report(packed ? "packVertices" : "packVertices (kept full)", pack);
+	report(narrowed ? "narrowIndices" : "narrowIndices (kept 32 bit)", narrow);
+	std::printf("processNode is %.2fx faster than the legacy conversion\n", legacy / convert);
+
+	// aiScene frees its meshes, faces and nodes
+	delete scene;
+	MirielEngine::Utils::GlobalJobSystem->cleanup();
+	MirielEngine::Utils::GlobalLogger->cleanup();
+	return 0;
+}
\ No newline at end of file
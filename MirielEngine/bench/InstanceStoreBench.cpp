@@ -0,0 +1,150 @@
+/*
+	Per instance cost of keeping world matrices up to date, 10k to 1M instances of one object:
+		legacy		the old ObjectInstance vector, every instance rebuilt T * R * S every frame like the draw list did
+		all moved	InstanceStore with every instance edited, the same steps Scene::updateTransforms takes (local
+					matrices for changed, hierarchy propagate, world matrices and moved written back)
+		1% moved	the same with one instance in a hundred edited, what a scene with a few animated things looks like
+	Instances are all roots here, a deeper hierarchy only adds the parent multiply to the propagate.
+
+	Not part of the engine build, from MirielEngine/ (the logger writes into Logs/, run it from a directory that has one):
+		cl /std:c++20 /O2 /EHsc /Iinclude bench\InstanceStoreBench.cpp src\Scenes\InstanceStore.cpp src\Scenes\TransformHierarchy.cpp
+			src\Utils\JobSystem.cpp src\Utils\MirielEngineLogger.cpp src\Utils\MirielEngineLogFormat.cpp src\Utils\MappedLogRing.cpp
+			src\Utils\MappedFile.cpp src\Utils\LogCompressor.cpp
+		g++ -std=c++20 -O2 "-Dlocaltime_s(a,b)=localtime_r(b,a)" -Iinclude bench/InstanceStoreBench.cpp src/Scenes/{InstanceStore,TransformHierarchy}.cpp \
+			src/Utils/{JobSystem,MirielEngineLogger,MirielEngineLogFormat,MappedLogRing,MappedFile,LogCompressor}.cpp -o InstanceStoreBench -lpthread
+	Optional argument: the largest instance count (default 1000000).
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Scenes/InstanceStore.hpp"
+#include "Scenes/TransformHierarchy.hpp"
+#include "Utils/JobSystem.hpp"
+#include "Utils/MirielEngineLogger.hpp"
+
+MirielEngine::Utils::Logger* MirielEngine::Utils::Logger::instance = nullptr;
+std::mutex MirielEngine::Utils::Logger::mtx;
+MirielEngine::Utils::JobSystem* MirielEngine::Utils::JobSystem::instance = nullptr;
+std::mutex MirielEngine::Utils::JobSystem::mtx;
+
+namespace {
+	using MirielEngine::Core::InstanceStore;
+	using MirielEngine::Core::TransformHierarchy;
+
+	// What ObjectInstance looked like before the store, Shader was a program id and a flag
+	struct LegacyInstance {
+		std::string vertexShaderName = "src/Shaders/default.vert";
+		std::string fragmentShaderName = "src/Shaders/default.frag";
+		struct { unsigned int program = 0; bool loaded = false; } shaderProgram;
+		glm::mat4 mTranslation = glm::mat4(1.0f);
+		glm::mat4 mScale = glm::mat4(1.0f);
+		glm::quat mRotation;
+		glm::vec3 vTranslation = glm::vec3(0.0f);
+		glm::vec3 vScale = glm::vec3(1.0f);
+		glm::vec3 vRotation = glm::vec3(0.0f);
+	};
+
+	glm::vec3 benchTranslation(size_t i) { return glm::vec3(static_cast<float>(i % 100), static_cast<float>(i / 100 % 100), static_cast<float>(i / 10000)); }
+	glm::vec3 benchRotation(size_t i) { return glm::vec3(static_cast<float>(i % 360), 45.0f, 0.0f); }
+
+	template <typename Function>
+	double bestNanosecondsPerInstance(size_t count, const Function& function) {
+		double best = 1e30;
+		for (int run = 0; run < 5; run++) {
+			auto start = std::chrono::steady_clock::now();
+			function();
+			best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best / count;
+	}
+
+	double benchLegacy(size_t count, std::vector<glm::mat4>& models) {
+		std::vector<LegacyInstance> instances(count);
+		for (size_t i = 0; i < count; i++) {
+			instances[i].vTranslation = benchTranslation(i);
+			instances[i].vRotation = benchRotation(i);
+			instances[i].mTranslation = glm::translate(glm::mat4(1.0f), instances[i].vTranslation);
+			instances[i].mRotation = glm::quat(glm::radians(instances[i].vRotation));
+		}
+		models.resize(count);
+
+		return bestNanosecondsPerInstance(count, [&]() {
+			for (size_t i = 0; i < count; i++) {
+				models[i] = instances[i].mTranslation * glm::mat4_cast(instances[i].mRotation) * instances[i].mScale;
+			}
+		});
+	}
+
+	// Scene::updateTransforms for a single object whose instances have no parents
+	void updateTransforms(InstanceStore& instances, TransformHierarchy& hierarchy) {
+		std::pmr::vector<uint32_t>& changed = instances.changed;
+		MirielEngine::Utils::GlobalJobSystem->parallel_for(0, changed.size(), 1024, [&instances, &hierarchy, &changed](size_t i) {
+			hierarchy.locals[instances.nodes[changed[i]]] = instances.getLocalMatrix(changed[i]);
+		});
+		for (uint32_t instance : changed) {
+			hierarchy.markDirty(instances.nodes[instance]);
+		}
+		instances.clearChanged();
+
+		hierarchy.propagate();
+		for (uint32_t node : hierarchy.changed) {
+			instances.worldMatrices[node] = hierarchy.worlds[node];
+			instances.moved.push_back(node);
+		}
+	}
+
+	double benchStore(size_t count, size_t stride) {
+		InstanceStore instances;
+		TransformHierarchy hierarchy;
+		instances.reserve(count);
+		hierarchy.reserve(count);
+		for (size_t i = 0; i < count; i++) {
+			instances.add(0, benchTranslation(i), benchRotation(i));
+			instances.nodes[i] = hierarchy.add(TransformHierarchy::NoParent, instances.getLocalMatrix(i));
+		}
+		updateTransforms(instances, hierarchy);
+		instances.moved.clear();
+
+		size_t edited = (count + stride - 1) / stride;
+		double perEdited = bestNanosecondsPerInstance(edited, [&]() {
+			// An editor drag or a script writing translations, then the frame's update
+			for (size_t i = 0; i < count; i += stride) {
+				instances.translations[i].x += 1.0f;
+				instances.markDirty(i);
+			}
+			updateTransforms(instances, hierarchy);
+			// The renderer's upload
+			instances.moved.clear();
+		});
+		// Spread over every instance in the scene, which is what a frame pays
+		return perEdited * edited / count;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	size_t maxCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+	std::printf("%zu workers, %u hardware threads\n", MirielEngine::Utils::GlobalJobSystem->getWorkerCount(), std::thread::hardware_concurrency());
+	std::printf("instances  legacy ns/instance  all moved ns/instance  1%% moved ns/instance\n");
+	std::vector<glm::mat4> models;
+	for (size_t count = 10000; count <= maxCount; count *= 10) {
+		double legacy = benchLegacy(count, models);
+		double allMoved = benchStore(count, 1);
+		double fewMoved = benchStore(count, 100);
+		std::printf("%9zu  %18.2f  %21.2f  %20.2f\n", count, legacy, allMoved, fewMoved);
+	}
+	if (!models.empty() && models.back()[3][3] != 1.0f) { std::printf("?\n"); }
+
+	MirielEngine::Utils::GlobalJobSystem->cleanup();
+	MirielEngine::Utils::GlobalLogger->cleanup();
+	return 0;
+}
\ No newline at end of file
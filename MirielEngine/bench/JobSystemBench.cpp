@@ -0,0 +1,97 @@
+/*
+	JobSystem scaling. The worker count is fixed when the singleton starts, so build once per MIRIEL_JOB_WORKERS
+	value and compare the runs:
+		parallel_for	1M 4x4 matrix products (about what propagating a large hierarchy costs) against a plain loop
+		fine jobs		100k tiny jobs submitted from the main thread under one counter, then waited on
+
+	Not part of the engine build, from MirielEngine/ (the logger writes into Logs/, run it from a directory that has one):
+		cl /std:c++20 /O2 /EHsc /DMIRIEL_JOB_WORKERS=4 /Iinclude bench\JobSystemBench.cpp src\Utils\JobSystem.cpp
+			src\Utils\MirielEngineLogger.cpp src\Utils\MirielEngineLogFormat.cpp src\Utils\MappedLogRing.cpp
+			src\Utils\MappedFile.cpp src\Utils\LogCompressor.cpp
+		for w in 1 2 4 8 16; do g++ -std=c++20 -O2 -DMIRIEL_JOB_WORKERS=$w "-Dlocaltime_s(a,b)=localtime_r(b,a)" -Iinclude \
+			bench/JobSystemBench.cpp src/Utils/{JobSystem,MirielEngineLogger,MirielEngineLogFormat,MappedLogRing,MappedFile,LogCompressor}.cpp \
+			-o JobSystemBench$w -lpthread && ./JobSystemBench$w; done
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "Utils/JobSystem.hpp"
+#include "Utils/MirielEngineLogger.hpp"
+
+MirielEngine::Utils::Logger* MirielEngine::Utils::Logger::instance = nullptr;
+std::mutex MirielEngine::Utils::Logger::mtx;
+MirielEngine::Utils::JobSystem* MirielEngine::Utils::JobSystem::instance = nullptr;
+std::mutex MirielEngine::Utils::JobSystem::mtx;
+
+namespace {
+	struct Matrix {
+		float m[16];
+	};
+
+	constexpr size_t matrixCount = 1000000;
+	constexpr size_t fineJobCount = 100000;
+
+	void multiply(const Matrix& a, const Matrix& b, Matrix& out) {
+		for (int column = 0; column < 4; column++) {
+			for (int row = 0; row < 4; row++) {
+				float sum = 0.0f;
+				for (int k = 0; k < 4; k++) { sum += a.m[k * 4 + row] * b.m[column * 4 + k]; }
+				out.m[column * 4 + row] = sum;
+			}
+		}
+	}
+
+	template <typename Function>
+	double bestMilliseconds(int runs, const Function& function) {
+		double best = 1e30;
+		for (int run = 0; run < runs; run++) {
+			auto start = std::chrono::steady_clock::now();
+			function();
+			best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best;
+	}
+}
+
+int main() {
+	using MirielEngine::Utils::GlobalJobSystem;
+
+	std::vector<Matrix> parents(matrixCount);
+	std::vector<Matrix> locals(matrixCount);
+	std::vector<Matrix> worlds(matrixCount);
+	for (size_t i = 0; i < matrixCount; i++) {
+		for (int j = 0; j < 16; j++) {
+			parents[i].m[j] = static_cast<float>((i + j) % 7) * 0.25f;
+			locals[i].m[j] = static_cast<float>((i * 3 + j) % 5) * 0.5f;
+		}
+	}
+
+	double serial = bestMilliseconds(5, [&]() {
+		for (size_t i = 0; i < matrixCount; i++) { multiply(parents[i], locals[i], worlds[i]); }
+	});
+	double parallel = bestMilliseconds(5, [&]() {
+		GlobalJobSystem->parallel_for(0, matrixCount, 1024, [&](size_t i) { multiply(parents[i], locals[i], worlds[i]); });
+	});
+
+	std::atomic<uint64_t> sum{ 0 };
+	double fine = bestMilliseconds(5, [&]() {
+		MirielEngine::Utils::JobCounter counter;
+		for (size_t i = 0; i < fineJobCount; i++) {
+			GlobalJobSystem->submit([&sum, i]() { sum.fetch_add(i, std::memory_order_relaxed); }, &counter);
+		}
+		GlobalJobSystem->wait(counter);
+	});
+
+	std::printf("%zu workers, %u hardware threads\n", GlobalJobSystem->getWorkerCount(), std::thread::hardware_concurrency());
+	std::printf("parallel_for: serial %.2f ms, job system %.2f ms, %.2fx\n", serial, parallel, serial / parallel);
+	std::printf("fine jobs: %.2f ms for %zu, %.0f ns per job\n", fine, fineJobCount, fine * 1e6 / fineJobCount);
+	if (worlds[matrixCount / 2].m[0] < -1.0f || sum.load() == 0) { std::printf("?\n"); }
+
+	GlobalJobSystem->cleanup();
+	MirielEngine::Utils::GlobalLogger->cleanup();
+	return 0;
+}
\ No newline at end of file
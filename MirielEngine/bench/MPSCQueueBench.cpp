@@ -0,0 +1,145 @@
+/*
+	Logger queue contention: MPSCRingBuffer with inline slots against the ThreadsafeQueue of heap allocated
+	messages the logger used before it. P producers each push their share of the messages, one consumer drains
+	them the way the logging thread does, time is from the first push to the last message being read.
+
+	Not part of the engine build, from MirielEngine/:
+		g++ -std=c++20 -O2 -Iinclude bench/MPSCQueueBench.cpp -o MPSCQueueBench -lpthread
+		cl /std:c++20 /O2 /EHsc /Iinclude bench\MPSCQueueBench.cpp
+	Optional arguments: total messages (default 2000000) and the largest producer count (default 16).
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Utils/MPSCRingBuffer.hpp"
+#include "Utils/ThreadsafeQueue.hpp"
+
+namespace {
+	using namespace MirielEngine::Utils::DataStructures;
+
+	// A typical loader line, short enough to stay inline
+	constexpr const char* benchMessage = "Loading in Object: src/Assets/Models/backpack/backpack.obj";
+
+	// What Logger::log used to allocate for every call
+	struct HeapMessage {
+		std::string msg;
+		std::chrono::system_clock::time_point time;
+	};
+
+	// Same shape as LoggingMessage's inline storage
+	struct SlotMessage {
+		int64_t time;
+		size_t length;
+		char inlineArgs[224];
+	};
+
+	double secondsSince(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	double benchThreadsafeQueue(size_t producers, size_t messages) {
+		ThreadsafeQueue<std::unique_ptr<HeapMessage>> queue;
+		std::atomic<bool> go{ false };
+		size_t perProducer = messages / producers;
+
+		std::vector<std::thread> threads;
+		for (size_t p = 0; p < producers; p++) {
+			threads.emplace_back([&]() {
+				while (!go.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+				for (size_t i = 0; i < perProducer; i++) {
+					auto message = std::make_unique<HeapMessage>();
+					message->msg = benchMessage;
+					message->time = std::chrono::system_clock::now();
+					queue.push(std::move(message));
+				}
+			});
+		}
+
+		size_t expected = perProducer * producers;
+		size_t received = 0;
+		size_t checksum = 0;
+		std::vector<std::unique_ptr<HeapMessage>> batch;
+		auto start = std::chrono::steady_clock::now();
+		go.store(true, std::memory_order_release);
+		while (received < expected) {
+			batch.clear();
+			if (queue.drain_into(batch) == 0) { std::this_thread::yield(); continue; }
+			for (const auto& message : batch) { checksum += message->msg.size(); }
+			received += batch.size();
+		}
+		double seconds = secondsSince(start);
+
+		for (auto& thread : threads) { thread.join(); }
+		if (checksum == 0) { std::printf("?"); }
+		return seconds;
+	}
+
+	double benchRingBuffer(size_t producers, size_t messages) {
+		MPSCRingBuffer<SlotMessage> ring(4096);
+		std::atomic<bool> go{ false };
+		size_t perProducer = messages / producers;
+		size_t length = std::strlen(benchMessage);
+
+		std::vector<std::thread> threads;
+		for (size_t p = 0; p < producers; p++) {
+			threads.emplace_back([&]() {
+				while (!go.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+				for (size_t i = 0; i < perProducer; i++) {
+					int64_t time = std::chrono::system_clock::now().time_since_epoch().count();
+					// Block policy, the logger yields while the ring is full
+					while (!ring.tryPush([&](SlotMessage& slot) {
+						slot.time = time;
+						slot.length = length;
+						std::memcpy(slot.inlineArgs, benchMessage, length);
+					})) {
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+
+		size_t expected = perProducer * producers;
+		size_t received = 0;
+		size_t checksum = 0;
+		auto start = std::chrono::steady_clock::now();
+		go.store(true, std::memory_order_release);
+		while (received < expected) {
+			if (!ring.tryPop([&](SlotMessage& slot) { checksum += slot.length; })) { std::this_thread::yield(); continue; }
+			received++;
+		}
+		double seconds = secondsSince(start);
+
+		for (auto& thread : threads) { thread.join(); }
+		if (checksum == 0) { std::printf("?"); }
+		return seconds;
+	}
+}
+
+int main(int argc, char* argv[]) {
+	size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+	size_t maxProducers = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+
+	std::printf("%zu messages, %u hardware threads\n", messages, std::thread::hardware_concurrency());
+	std::printf("producers  ThreadsafeQueue ns/msg  MPSCRingBuffer ns/msg  speedup\n");
+	for (size_t producers = 1; producers <= maxProducers; producers *= 2) {
+		// Best of three, the first run of each also warms up the allocator
+		double queueSeconds = 1e30;
+		double ringSeconds = 1e30;
+		for (int run = 0; run < 3; run++) {
+			queueSeconds = std::min(queueSeconds, benchThreadsafeQueue(producers, messages));
+			ringSeconds = std::min(ringSeconds, benchRingBuffer(producers, messages));
+		}
+		double queueNs = queueSeconds * 1e9 / messages;
+		double ringNs = ringSeconds * 1e9 / messages;
+		std::printf("%9zu  %22.1f  %21.1f  %6.2fx\n", producers, queueNs, ringNs, queueNs / ringNs);
+	}
+	return 0;
+}
\ No newline at end of file
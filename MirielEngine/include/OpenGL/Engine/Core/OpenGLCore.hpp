@@ -1,13 +1,87 @@
 #pragma once
 
 #include <vector>
+#include <deque>
 #include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <functional>
 
 #include <glad/glad.h>
 
 #include "Scenes/Objects.hpp"
+#include "Utils/JobSystem.hpp"
+#include "Utils/ThreadsafeQueue.hpp"
+
+// Most texture bytes copied into the upload PBO per frame, at least one texture always goes up so bigger ones still finish
+#ifndef MIRIEL_TEXTURE_UPLOAD_BUDGET_BYTES
+#define MIRIEL_TEXTURE_UPLOAD_BUDGET_BYTES (8 * 1024 * 1024)
+#endif
+
+// Most time spent uploading textures per frame in milliseconds
+#ifndef MIRIEL_TEXTURE_UPLOAD_BUDGET_MS
+#define MIRIEL_TEXTURE_UPLOAD_BUDGET_MS 2.0
+#endif
 
 namespace MirielEngine::OpenGL {
+	struct DecodedImageDeleter {
+		void operator()(unsigned char* pixels) const;
+	};
+
+	/*
+		A texture whose pixels have been decoded on a worker and are waiting for their turn to go through the upload PBO.
+		ID is the placeholder texture loadTexture handed out, the pixels replace its contents so the handle never changes.
+	*/
+	struct DecodedTexture {
+		GLuint ID = 0;
+		uint64_t generation = 0;
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+		std::unique_ptr<unsigned char, DecodedImageDeleter> pixels;
+		std::string name;
+	};
+
+	/*
+		Neighbouring instances of an object with the same program, built off the main thread by prepareFrame and sorted
+		so state only changes between batches. Each of the object's meshes is one instanced draw, the vertex shader reads
+		the instance's world matrix at gl_BaseInstance + gl_InstanceID and the mesh's own matrix at the node uniform.
+	*/
+	struct DrawItem {
+		GLuint program;
+		GLint nodeLocation;
+		GLuint VAO;
+		uint32_t object;
+		GLuint firstInstance;
+		GLsizei instanceCount;
+	};
+
+	enum class TransformBuffer : uint8_t {
+		Instances,
+		Nodes
+	};
+
+	// Matrices [first, first + count) of one of an object's transform buffers, they start at uploadOffset in transformUploads
+	struct TransformRange {
+		uint32_t object;
+		uint32_t first;
+		uint32_t count;
+		size_t uploadOffset;
+		TransformBuffer buffer;
+	};
+
+	// Everything draw needs from the scene for one frame, nothing in it points back into the scene
+	struct FrameSnapshot {
+		std::vector<DrawItem> drawList;
+		// Only the world matrices that changed since the last frame
+		std::vector<TransformRange> transformRanges;
+		std::vector<glm::mat4> transformUploads;
+		glm::mat4 view;
+		glm::mat4 projection;
+		uint64_t generation;
+	};
+
 	class OpenGLCore {
 		private:
 			std::vector<GLuint> objectVBOs;
@@ -19,12 +93,52 @@ namespace MirielEngine::OpenGL {
 			std::vector<GLuint> particleVAOs;
 			std::vector<GLuint> textures;
 			std::vector<GLuint> programs;
+			// Where each program keeps its node uniform, -1 if it doesn't use it
+			std::vector<GLint> nodeLocations;
+			// Per object SSBO of instance world matrices, grown on the GL thread as instances are added
+			std::vector<GLuint> transformSSBOs;
+			std::vector<size_t> transformCapacities;
+			// Per object SSBO with each mesh range's node world matrix
+			std::vector<GLuint> nodeSSBOs;
+			// Per object SSBO with each mesh range's Object::getPositionDequantize, written once with the vertices
+			std::vector<GLuint> dequantizeSSBOs;
+			// GL thread copy of each object's mesh ranges, so drawing never reads the scene
+			std::vector<std::vector<MirielEngine::Core::MeshRange>> objectMeshes;
+			// Same for Object::vertexColor, compact objects draw with it as a constant attribute
+			std::vector<glm::vec3> objectVertexColors;
+			// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, whichever the object's element buffer was uploaded as
+			std::vector<GLenum> objectIndexTypes;
 			std::shared_ptr<MirielEngine::Core::Scene> scene;
 			size_t currentProgram;
+
+			// Written by prepareFrame, drawn straight from here or handed over to the render thread
+			FrameSnapshot preparedFrame;
+			// When cleanUp has bumped resourceGeneration since, the transform buffers are gone and everything is uploaded again
+			uint64_t preparedGeneration;
+
+			// Whoever has the context current, GL calls from anywhere else go through glCommands
+			std::atomic<std::thread::id> glThreadID;
+			MirielEngine::Utils::DataStructures::ThreadsafeQueue<std::function<void()>> glCommands;
+
+			// Texture streaming, decodes run on the job system and finished images are uploaded a few per frame
+			MirielEngine::Utils::JobCounter textureDecodes;
+			MirielEngine::Utils::DataStructures::ThreadsafeQueue<DecodedTexture> decodedTextures;
+			std::deque<DecodedTexture> pendingUploads;
+			GLuint textureUploadPBO;
+			// Bumped by cleanUp and removeObject so decodes and frames built against objects that have since been deleted or moved are thrown away
+			uint64_t resourceGeneration;
+			size_t texturesStreamed;
+
+			void processTextureUploads();
+			void uploadTexture(const DecodedTexture& texture);
+			void uploadTransforms(const FrameSnapshot& frame);
+			void reserveTransformBuffer(uint32_t object, size_t instanceCount);
 		public:
 			OpenGLCore();
 			~OpenGLCore();
 			void cleanUp();
+			// Deletes the object's GL side and swaps the last object into index, same as the scene is about to
+			void removeObject(size_t index);
 			void createBuffers();
 			void updateBuffers();
 			void createProgram();
@@ -32,7 +146,20 @@ namespace MirielEngine::OpenGL {
 			void nextProgram();
 			void previousProgram();
 			unsigned int loadTexture(const std::string& textureName);
-			void draw(int width, int height);
+			// GL side of keeping up with the scene (new objects and shaders), has to run while nothing else touches the scene
+			void syncResources();
+			// CPU only, reads the scene and fills the draw list so it can run on a worker
+			void prepareFrame(int width, int height);
+			FrameSnapshot& getPreparedFrame();
+			// GL thread only, also streams in any textures that have finished decoding
+			void draw(const FrameSnapshot& frame);
+
+			void setGLThread(std::thread::id id);
+			bool isGLThread() const;
+			// Runs command on the GL thread and waits for it, straight away if this is the GL thread
+			void invokeGL(const std::function<void()>& command);
+			// GL thread only, returns how many queued commands were run
+			size_t runGLCommands();
 			std::shared_ptr<MirielEngine::Core::Scene> getScene();
 	};
 }
\ No newline at end of file
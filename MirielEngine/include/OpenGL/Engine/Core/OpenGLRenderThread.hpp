@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "DearImGui/imgui.h"
+#include "OpenGL/Engine/Core/OpenGLCore.hpp"
+
+// 1 hands the GL context to a render thread so GUI, input and loading on the main thread never wait on submission
+#ifndef MIRIEL_RENDER_THREAD
+#define MIRIEL_RENDER_THREAD 0
+#endif
+
+namespace MirielEngine::OpenGL {
+	// One frame as the render thread sees it, copied out so the main thread can start editing the scene and GUI again
+	struct RenderSnapshot {
+		FrameSnapshot scene;
+		ImDrawData guiDrawData;
+		// Owned copies of the ImGui draw lists, kept between frames so their buffers are reused
+		std::vector<ImDrawList*> guiDrawLists;
+	};
+
+	/*
+		Owns the GL context while it runs. The main thread fills a snapshot and publishes it, the render thread always
+		draws the newest one it has been given and drops any it never got to. Three slots means neither side ever waits
+		for the other to finish with one: the main thread writes into one, the render thread draws from another and the
+		third holds the latest published frame between them. GL work the main thread still has (new buffers, shaders,
+		texture handles, New Scene) goes through OpenGLCore::invokeGL.
+	*/
+	class OpenGLRenderThread {
+		private:
+			GLFWwindow* window;
+			OpenGLCore* core;
+			std::thread thread;
+			std::atomic<bool> running;
+
+			RenderSnapshot snapshots[3];
+			size_t writeIndex;
+			size_t publishedIndex;
+			size_t readIndex;
+			bool hasPublished;
+			std::mutex snapshotMtx;
+			std::condition_variable snapshotPublished;
+			std::condition_variable snapshotTaken;
+
+			std::atomic<uint64_t> framesRendered;
+			std::atomic<uint64_t> framesDropped;
+
+			void renderLoop();
+			bool takeSnapshot();
+			static void carryTransforms(const FrameSnapshot& dropped, FrameSnapshot& next);
+			static void copyDrawData(RenderSnapshot& snapshot, const ImDrawData* drawData);
+		public:
+			OpenGLRenderThread(GLFWwindow* window, OpenGLCore* core);
+			~OpenGLRenderThread();
+			OpenGLRenderThread(const OpenGLRenderThread&) = delete;
+			OpenGLRenderThread& operator=(const OpenGLRenderThread&) = delete;
+
+			// The calling thread has to have the context current, it gets it back from stop
+			void start();
+			void stop();
+
+			// Main thread, takes the core's prepared frame and a copy of ImGui's draw data
+			void publish(const ImDrawData* drawData);
+			// Main thread, paces it to the render thread without letting a slow GPU frame hold it for longer than timeout
+			void waitForRender(std::chrono::milliseconds timeout);
+
+			uint64_t getFramesRendered() const { return framesRendered.load(std::memory_order_relaxed); }
+			uint64_t getFramesDropped() const { return framesDropped.load(std::memory_order_relaxed); }
+	};
+}
\ No newline at end of file
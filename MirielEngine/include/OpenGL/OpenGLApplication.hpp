@@ -2,8 +2,11 @@
 
 #include "glad/glad.h"
 #include "Utils/MirielEngineLogger.hpp"
+#include "Utils/JobSystem.hpp"
+#include "Utils/FrameGraph.hpp"
 #include "Utils/MirielEngineWindow.hpp"
 #include "OpenGL/Engine/Core/OpenGLCore.hpp"
+#include "OpenGL/Engine/Core/OpenGLRenderThread.hpp"
 #include "Utils/DearImGuiFrame.hpp"
 
 namespace MirielEngine::OpenGL {
@@ -21,8 +24,12 @@ namespace MirielEngine::OpenGL {
 
 			std::unique_ptr<MirielEngine::OpenGL::OpenGLCore> core;
 			std::unique_ptr<MirielEngine::Utils::GUI> gui;
+			std::unique_ptr<MirielEngine::Utils::FrameGraph> frameGraph;
+			// Only with MIRIEL_RENDER_THREAD, declared after core so it is stopped before core goes away
+			std::unique_ptr<MirielEngine::OpenGL::OpenGLRenderThread> renderThread;
 
 			void initializeDearImGUI();
+			void buildFrameGraph();
 		public:
 			OpenGLApplication();
 			~OpenGLApplication() = default;
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <memory_resource>
+#include <cstdint>
+#include <limits>
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "Utils/SlotMap.hpp"
+
+namespace MirielEngine::Core {
+	// One instance of one object, object is empty for no instance at all
+	struct InstanceRef {
+		static constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+
+		uint32_t object = None;
+		uint32_t instance = None;
+
+		bool empty() const { return object == None; }
+	};
+
+	// Same as InstanceRef but stays pointing at the same instance while others are removed, and goes stale with it
+	struct InstanceHandle {
+		MirielEngine::Utils::DataStructures::SlotHandle object;
+		MirielEngine::Utils::DataStructures::SlotHandle instance;
+
+		bool empty() const { return object.empty(); }
+	};
+
+	/*
+		Every instance of one object, stored as parallel arrays so index i in each of them is the same instance.
+		Anything that only needs world matrices (or only translations) streams through just that array instead of
+		pulling whole instances through the cache.
+
+		Anything that edits an instance calls markDirty. Scene::updateTransforms only rebuilds the local matrices of
+		instances in changed, pushes them through the instance hierarchy and lists every instance whose world matrix
+		came out different in moved. The renderer uploads just those, so a scene nobody touches costs nothing.
+
+		Indices shift when an instance is removed (the last one is swapped into its place), anything that has to keep
+		pointing at an instance holds the handle add gave back instead.
+	*/
+	class InstanceStore {
+		private:
+			MirielEngine::Utils::DataStructures::HandleTable handles;
+		public:
+			std::pmr::vector<glm::vec3> translations;
+			// Euler angles in degrees, what the editor shows and scene files store
+			std::pmr::vector<glm::vec3> rotations;
+			// rotations as quats, kept in step by updateRotation so the matrix build doesn't redo the trig
+			std::pmr::vector<glm::quat> orientations;
+			std::pmr::vector<glm::vec3> scales;
+			// Includes every parent's transform, written by Scene::updateTransforms
+			std::pmr::vector<glm::mat4> worldMatrices;
+			// Instance this one moves with, translations/rotations/scales are relative to it
+			std::pmr::vector<InstanceHandle> parents;
+			// Node in Scene::instanceHierarchy
+			std::pmr::vector<uint32_t> nodes;
+			// Index into Scene::shaderCombinations
+			std::pmr::vector<uint32_t> shaderCombinations;
+			// 1 while the instance is in changed, stops it being queued twice
+			std::pmr::vector<uint8_t> dirty;
+			// Instances edited since the last Scene::updateTransforms, in no particular order
+			std::pmr::vector<uint32_t> changed;
+			// Instances whose world matrix changed and hasn't been uploaded yet, the renderer clears it
+			std::pmr::vector<uint32_t> moved;
+
+			explicit InstanceStore(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+			size_t size() const { return translations.size(); }
+			bool empty() const { return translations.empty(); }
+			void reserve(size_t count);
+			void clear();
+
+			// The new instance always goes at the back
+			MirielEngine::Utils::DataStructures::SlotHandle add(uint32_t shaderCombination, const glm::vec3& translation = glm::vec3(0.0f),
+						const glm::vec3& rotation = glm::vec3(0.0f), const glm::vec3& scale = glm::vec3(1.0f));
+			// False for a stale handle. Nodes are left pointing at the old hierarchy, the scene has to rebuild it
+			bool remove(MirielEngine::Utils::DataStructures::SlotHandle handle);
+
+			size_t indexOf(MirielEngine::Utils::DataStructures::SlotHandle handle) const { return handles.indexOf(handle); }
+			MirielEngine::Utils::DataStructures::SlotHandle handleAt(size_t i) const { return handles.handleAt(i); }
+
+			// Call after writing rotations[i] directly, markDirty is still needed for the matrix
+			void updateRotation(size_t i);
+			glm::mat4 getLocalMatrix(size_t i) const;
+
+			void markDirty(size_t i);
+			void markAllDirty();
+			void clearChanged();
+	};
+}
\ No newline at end of file
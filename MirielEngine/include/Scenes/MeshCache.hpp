@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "Objects.hpp"
+
+// Set to 0 to always import models through Assimp
+#ifndef MIRIEL_MESH_CACHE
+#define MIRIEL_MESH_CACHE 1
+#endif
+
+namespace MirielEngine::Core {
+	// Where a model's cooked copy lives and what it has to match, cachePath is empty when the source couldn't be read
+	struct MeshCacheKey {
+		std::string cachePath;
+		uint64_t sourceHash;
+		// Import flags and every setting that changes what the import produces
+		uint64_t settingsHash;
+	};
+
+	/*
+		Cooked models live in Cache/ as .mmesh files: the final vertex and index buffers exactly as they get uploaded,
+		mesh ranges with their bounds, the node tree and texture references. Loading one is a mapping and a copy per
+		stream instead of Assimp and the whole optimize/pack pass. A file is only used while the source's contents and
+		the import settings still hash the same, anything else falls back to a normal import, which cooks it again.
+		The source hash covers the model file plus a .obj's mtllib files and a .gltf's .bin buffers. Anything else a
+		format pulls in isn't followed, so changing it needs the cooked file in Cache/ deleted by hand.
+	*/
+	MeshCacheKey getMeshCacheKey(const std::string& objectName, unsigned int importFlags);
+	// Leaves object untouched and returns false on a miss or a file that doesn't check out
+	bool loadCachedObject(const MeshCacheKey& key, Object* object, const TextureLoadFunction& textureLoader);
+	// Written to a temporary file and renamed over, a crash halfway never leaves a truncated .mmesh behind
+	bool cookObject(const MeshCacheKey& key, const Object& object);
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Objects.hpp"
+
+// Set to 0 to upload meshes exactly as Assimp gives them
+#ifndef MIRIEL_OPTIMIZE_MESHES
+#define MIRIEL_OPTIMIZE_MESHES 1
+#endif
+
+// Set to 0 to keep uploading full float vertices
+#ifndef MIRIEL_COMPACT_VERTICES
+#define MIRIEL_COMPACT_VERTICES 1
+#endif
+
+// Post-transform cache size triangles are ordered for, 16 is safe on anything recent and close enough on the rest
+#ifndef MIRIEL_VERTEX_CACHE_SIZE
+#define MIRIEL_VERTEX_CACHE_SIZE 16
+#endif
+
+namespace MirielEngine::Core {
+	// How often vertices miss a FIFO post-transform cache, lower is better for both
+	struct VertexCacheStats {
+		// Vertex shader runs per triangle, 3 is no reuse at all and a regular grid bottoms out around 0.5
+		double ACMR;
+		// Vertex shader runs per vertex, 1 means every vertex only went through once
+		double ATVR;
+	};
+
+	struct MeshOptimizationStats {
+		VertexCacheStats before;
+		VertexCacheStats after;
+		size_t verticesBefore;
+		size_t verticesAfter;
+	};
+
+	VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, size_t cacheSize = MIRIEL_VERTEX_CACHE_SIZE);
+
+	/*
+		Welds identical vertices, reorders each mesh's triangles for the post-transform cache (Tipsify) and then its
+		vertices into the order the triangles first use them, so fetches walk the vertex buffer forwards. Done one mesh
+		range at a time, indices stay relative to their mesh and only the baseVertex of each range moves.
+	*/
+	MeshOptimizationStats optimizeObject(Object* object);
+
+	/*
+		Packs vertices into compactVertices and switches the object over to VertexLayout::Compact. Colour only survives
+		as one constant, so an object whose vertices don't all share it stays on the full layout and this returns false.
+	*/
+	bool packVertices(Object* object);
+
+	/*
+		Copies indices down to shortIndices and switches the object to IndexType::UInt16 when they all fit. Indices only
+		count up from their own mesh's baseVertex, so it's one mesh with more than 65535 vertices that keeps a model at 32 bits.
+	*/
+	bool narrowIndices(Object* object);
+}
\ No newline at end of file
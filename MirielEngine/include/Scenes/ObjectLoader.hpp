@@ -10,9 +10,13 @@
 
 namespace MirielEngine::Core {
 	void loadObject(const std::string& objectName, MirielEngine::Core::Object* object, const TextureLoadFunction& textureLoader);
+	// Walks the whole tree under node breadth first, filling the object's node hierarchy and mesh ranges
 	void processNode(aiNode* node, const aiScene* scene, MirielEngine::Core::Object* object, const TextureLoadFunction& textureLoader);
-	void processMesh(aiMesh* mesh, const aiScene* scene, MirielEngine::Core::Object* object, const TextureLoadFunction& textureLoader);
+	MeshRange processMesh(aiMesh* mesh, const aiScene* scene, MirielEngine::Core::Object* object, const TextureLoadFunction& textureLoader);
+	// An empty textureLoader leaves texture IDs at 0 so imports can run off the main thread
 	void loadMaterials(aiMaterial* material, aiTextureType type, std::string typeName, MirielEngine::Core::Object* object, const TextureLoadFunction& textureLoader);
+	void resolveObjectTextures(MirielEngine::Core::Object* object, const TextureLoadFunction& textureLoader);
+	bool isModelFile(const std::string& path);
 
 	// TODO: Compress Texture Function
 	void compressTexture(const std::string& textureName);
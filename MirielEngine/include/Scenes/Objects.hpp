@@ -3,26 +3,38 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <memory_resource>
 #include <unordered_map>
+#include <unordered_set>
 #include <functional>
 
 #include <assimp/types.h>
 
 #include <glm/gtc/quaternion.hpp>
+#include <glm/vec4.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec2.hpp>
 #include <glm/mat4x4.hpp>
 
 #include "Camera.hpp"
 #include "Light.hpp"
+#include "InstanceStore.hpp"
+#include "TransformHierarchy.hpp"
+#include "Utils/Task.hpp"
+#include "Utils/StringInterner.hpp"
+#include "Utils/FlatHashMap.hpp"
+#include "Utils/SlotMap.hpp"
+#include "Utils/MonotonicArena.hpp"
 
 namespace MirielEngine::Core {
 	using TextureLoadFunction = std::function<unsigned int(const std::string&)>;
 	using CleanGraphicsAPIFunction = std::function<void ()>;
+	// Called with an object's index just before it's swapped out of Scene::objects, the backend has to make the same swap
+	using RemoveGraphicsObjectFunction = std::function<void(size_t)>;
 
 	struct Texture {
 		unsigned int ID;
-		std::string type;	// TODO: replace with enum
+		MirielEngine::Utils::StringID type;	// interned, "texture_diffuse", "texture_specular", ...
 		aiString path;		// TODO: Replace with something smaller?
 	};
 
@@ -32,6 +44,13 @@ namespace MirielEngine::Core {
 		bool loaded;
 	};
 
+	// A vertex and fragment shader pair, instances refer to these by index. Either path can be empty while one is being picked in the editor
+	struct ShaderCombination {
+		MirielEngine::Utils::StringID vertexShader;
+		MirielEngine::Utils::StringID fragmentShader;
+		Shader shader;
+	};
+
 	struct Vertex {
 		glm::vec3 aPos;
 		glm::vec3 normal;
@@ -39,74 +58,166 @@ namespace MirielEngine::Core {
 		glm::vec2 texCoord;
 	};
 
+	enum class VertexLayout : uint8_t {
+		// Vertex as imported, 44 bytes
+		Full,
+		// CompactVertex, 16 bytes, every vertex has the same colour so it's a constant attribute instead
+		Compact
+	};
+
+	/*
+		Position is 16 bit unorm across its mesh's bounds, shaders scale and offset it back with the mesh's
+		PositionDequantize before anything else touches it. Normal is snorm 10/10/10/2 and the UV is two half floats, vertex fetch
+		expands all of them on its own.
+	*/
+	struct CompactVertex {
+		uint16_t position[3];
+		uint16_t padding;
+		uint32_t normal;
+		uint32_t texCoord;
+	};
+
+	enum class IndexType : uint8_t {
+		UInt16,
+		UInt32
+	};
+
+	// One mesh drawn at one model node, indices start from 0 for every mesh so they're offset by baseVertex when drawn
+	struct MeshRange {
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		int32_t baseVertex;
+		uint32_t node;
+		// Model space bounds of the mesh's vertices
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+	};
+
+	// aPos * scale + offset is the model space position, vec4s so the array lines up the same in std430
+	struct PositionDequantize {
+		glm::vec4 offset;
+		glm::vec4 scale;
+	};
+
+	// Geometry comes from whatever resource it's made with, the scene's arena for anything that ends up in Scene::objects
 	struct Object {
-		std::string vertexShaderName;
-		std::string fragmentShaderName;
+		// Default shader paths for new instances, interned
+		MirielEngine::Utils::StringID vertexShader = MirielEngine::Utils::StringInterner::Empty;
+		MirielEngine::Utils::StringID fragmentShader = MirielEngine::Utils::StringInterner::Empty;
 		std::string path;
-		std::vector<Vertex> vertices;
-		std::vector<unsigned int> indices;
-		std::vector<Texture> textures;
+		// Kept as imported even once packed, for anything that wants full precision on the CPU. Objects loaded from the
+		// mesh cache only have the buffers that get uploaded, so this and indices can be empty
+		std::pmr::vector<Vertex> vertices;
+		// Only filled for VertexLayout::Compact, same order as vertices
+		std::pmr::vector<CompactVertex> compactVertices;
+		VertexLayout vertexLayout = VertexLayout::Full;
+		// What every vertex's colour was when the layout leaves it out
+		glm::vec3 vertexColor = glm::vec3(1.0f);
+		std::pmr::vector<unsigned int> indices;
+		// Same indices at 16 bits, only filled for IndexType::UInt16
+		std::pmr::vector<uint16_t> shortIndices;
+		IndexType indexType = IndexType::UInt32;
+		std::pmr::vector<Texture> textures;
+		// The model's own node tree, world matrices here are relative to the model rather than the scene
+		TransformHierarchy nodes;
+		std::pmr::vector<MeshRange> meshes;
+		// Set when nodes changed, cleared by the backend once it has the new matrices
+		bool nodesMoved = false;
+
+		explicit Object(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
 		std::string getName();
+		// Identity for the full layout, kept apart from the node matrices so normals never see it
+		PositionDequantize getPositionDequantize(const MeshRange& mesh) const;
 	};
 
 	struct ParticleSpawner {
-		std::vector<std::string> shaders;
-		std::vector<glm::vec3> particlePositions;
-		std::vector<float> particleLifetimes;
+		// Vertex and fragment shader, interned
+		std::pmr::vector<MirielEngine::Utils::StringID> shaders;
+		std::pmr::vector<glm::vec3> particlePositions;
+		std::pmr::vector<float> particleLifetimes;
 		glm::vec3 position;
 		glm::vec3 color;
 		// give a certain program so that the particles choose their own shader, issue for Vulkan and D3D12 since they have entire pipelines
-	};
 
-	struct ObjectInstance {
-		// materials or colors later?
-		// TODO: Check if shader name is default shader for object, ignore if true
-		std::string vertexShaderName;
-		std::string fragmentShaderName;
-		Shader shaderProgram; // TODO: Check wording and feasibility
-		glm::mat4 mTranslation;
-		glm::mat4 mScale;
-		glm::quat mRotation;
-		glm::vec3 vTranslation;
-		glm::vec3 vScale;
-		glm::vec3 vRotation;
-
-		ObjectInstance(const Object& o);
-		~ObjectInstance();
-
-		void updateTranslation();
-		void updateScale();
-		void updateRotation();
+		explicit ParticleSpawner(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 	};
 
+	/*
+		Objects, lights and particle spawners live in slot maps, so they stay packed for anything walking over them and can
+		be removed in constant time. Removing swaps the last one into the gap, anything that needs to hold on to one of
+		them past the current frame (the editor's selection, instance parents) keeps a handle instead of an index.
+
+		Geometry, instances and particles are allocated from arena, which newScene hands back to the heap in one go
+		once everything using it has been cleared. Removing something in the editor doesn't give its memory back
+		until then.
+	*/
 	struct Scene {
-		std::unordered_map<std::string, size_t> loadedObjectNames; // <- Could potentially be replaced by a vector assuming that objects are grouped properly in file
-		std::unordered_map<size_t, std::vector<ObjectInstance>> objectInstances;
-		std::unordered_map<std::string, Shader> loadedShaderCombinations;
+		// First so it's destroyed after everything allocated from it
+		MirielEngine::Utils::MonotonicArena arena;
+
+		std::unordered_map<std::string, MirielEngine::Utils::DataStructures::SlotHandle> loadedObjectNames;
+		std::vector<InstanceStore> objectInstances; // one store per object, same index as objects
+		// Every instance of every object, breadth first so parented instances come after their parents
+		TransformHierarchy instanceHierarchy;
+		std::vector<InstanceRef> instanceHierarchyOwners; // which instance each node belongs to
+		bool instanceHierarchyChanged = false;
+		std::vector<ShaderCombination> shaderCombinations;
+		// (vert ID << 32 | frag ID) to its index in shaderCombinations
+		MirielEngine::Utils::DataStructures::FlatHashMap<uint64_t, uint32_t> loadedShaderCombinations;
 		TextureLoadFunction textureLoader;
 		CleanGraphicsAPIFunction clearAPIFunction;
+		RemoveGraphicsObjectFunction removeObjectFunction;
 		std::string scenePath;
-		std::vector<Object> objects;
-		std::vector<ParticleSpawner> particles;
+		MirielEngine::Utils::DataStructures::SlotMap<Object> objects;
+		MirielEngine::Utils::DataStructures::SlotMap<ParticleSpawner> particles;
 
-		std::vector<Light> pointLights;
-		std::vector<Light> directionalLights;
+		MirielEngine::Utils::DataStructures::SlotMap<Light> pointLights;
+		MirielEngine::Utils::DataStructures::SlotMap<Light> directionalLights;
+
+		// Parent tags loadSceneObject has read as file indices, resolved once loadSceneFile has every object
+		std::vector<std::pair<InstanceHandle, InstanceRef>> unresolvedParents;
 
 		Camera camera;
 
+		// Objects added from the editor import in the background, the names stop the same file being picked twice meanwhile
+		MirielEngine::Utils::JobCounter pendingImports;
+		std::unordered_set<std::string> importingObjectNames;
+
 		void loadSceneFile(const std::string& sceneName);
-		void loadSceneObject(std::ifstream* sceneFile, const std::string& objName);
+		// importedObject is a model loadSceneFile already imported on a worker, null loads it here instead
+		void loadSceneObject(std::ifstream* sceneFile, const std::string& objName, Object* importedObject = nullptr);
 		void loadSceneParticle(std::ifstream* sceneFile);
 		void loadSceneCamera(std::ifstream* sceneFile);
 		void loadSceneLight(std::ifstream* sceneFile);
 
 		void addPointLight();
 		void addDirectionalLight();
+		void removePointLight(MirielEngine::Utils::DataStructures::SlotHandle light);
+		void removeDirectionalLight(MirielEngine::Utils::DataStructures::SlotHandle light);
+		void removeParticleSpawner(MirielEngine::Utils::DataStructures::SlotHandle spawner);
+		// Finds the pair or adds it, backends pick up new entries and build their programs
+		uint32_t addShaderCombination(MirielEngine::Utils::StringID vertexShader, MirielEngine::Utils::StringID fragmentShader);
 		void addObjectInstance(size_t index);
+		// Children of a removed instance are detached the next time the hierarchy is rebuilt
+		void removeObjectInstance(InstanceHandle instance);
+		// Takes every instance of the object with it
+		void removeObject(MirielEngine::Utils::DataStructures::SlotHandle object);
+		// Where the instance is right now, empty once it's been removed
+		InstanceRef findInstance(InstanceHandle instance) const;
+		InstanceHandle getInstanceHandle(InstanceRef instance) const;
+		// False when it would make a loop, an empty parent detaches the instance
+		bool setInstanceParent(InstanceHandle child, InstanceHandle parent);
+		// Pushes edited instances and model nodes through their hierarchies, world changes end up in each store's moved list
+		void updateTransforms();
+		void rebuildInstanceHierarchy();
+		void markAllTransformsDirty();
 		void switchVertShader(size_t objectIndex, size_t instanceIndex);
 		void switchFragShader(size_t objectIndex, size_t instanceIndex);
 		void addObject();
+		MirielEngine::Utils::Task importObject(std::string path, Object object);
+		// Finishes every background import, they need the scene and the graphics API to still be there
+		void waitForImports();
 
 		void saveScene();
 		void saveSceneAs();
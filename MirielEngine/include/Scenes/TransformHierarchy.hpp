@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <limits>
+
+#include <glm/mat4x4.hpp>
+
+namespace MirielEngine::Core {
+	/*
+		Parent/child transforms stored breadth first, so every node comes after its parent and each depth is one
+		contiguous run of nodes. A level only needs the one above it finished, so propagate goes down one level at a time
+		and hands that level's dirty nodes to the job system in one go. Dirty nodes are kept in a list per level and
+		each one adds its children to the next, so moving one node only ever touches that node and its subtree.
+	*/
+	class TransformHierarchy {
+		public:
+			static constexpr uint32_t NoParent = std::numeric_limits<uint32_t>::max();
+
+			std::vector<uint32_t> parents;
+			std::vector<uint32_t> depths;
+			std::vector<glm::mat4> locals;
+			std::vector<glm::mat4> worlds;
+			// First node of each depth, level d runs up to the start of d + 1 or the end
+			std::vector<uint32_t> levelStarts;
+			// Nodes the last propagate rebuilt the world matrix of, in breadth first order
+			std::vector<uint32_t> changed;
+
+			size_t size() const { return parents.size(); }
+			bool empty() const { return parents.empty(); }
+			void reserve(size_t count);
+			void clear();
+
+			// Nodes have to be added breadth first, parent is an earlier node or NoParent for a root. Returns the new node
+			uint32_t add(uint32_t parent, const glm::mat4& local);
+			void setLocal(uint32_t node, const glm::mat4& local);
+			void markDirty(uint32_t node);
+			void markAllDirty();
+			// Rebuilds the world matrix of every dirty node and everything under them and fills changed
+			void propagate();
+		private:
+			static constexpr uint32_t NoLevel = std::numeric_limits<uint32_t>::max();
+
+			std::vector<std::vector<uint32_t>> children;
+			// 1 for nodes already in their level's dirty list, propagate spreads it to their children as it goes down
+			std::vector<uint8_t> dirty;
+			std::vector<std::vector<uint32_t>> dirtyLevels;
+			uint32_t firstDirtyLevel = NoLevel;
+	};
+}
\ No newline at end of file
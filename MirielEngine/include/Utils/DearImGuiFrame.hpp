@@ -6,6 +6,7 @@
 #include "DearImGui/imgui.h"
 
 #include "Scenes/Objects.hpp"
+#include "Utils/FrameGraph.hpp"
 
 namespace MirielEngine::Utils {
 	using ImGuiImplementationFunction = std::function<void ()>;
@@ -14,19 +15,30 @@ namespace MirielEngine::Utils {
 		ImGuiIO& io;
 		std::string selectedName;
 		std::weak_ptr<MirielEngine::Core::Scene> scene;
-		/*
-			Current List will keep track of what list I am currently looking at
-				0: directional lights
-				1: point lights
-				2+: objects in scene starting at 0
+		enum class Selection {
+			None,
+			DirectionalLight,
+			PointLight,
+			Instance
+		};
 
-			Current Object will let me know what item in the list I am looking at, so 0 is 0th index, etc.
+		/*
+			What the selected item pane is showing. Held by handle, removing anything else can't move the selection onto
+			a different item and removing the selected item just clears it.
 		*/
-		size_t currentList;
-		size_t currentObject;
+		Selection selection;
+		MirielEngine::Utils::DataStructures::SlotHandle selectedLight;
+		MirielEngine::Core::InstanceHandle selectedInstance;
+		// Object and instance typed in for the selected instance's parent
+		int parentInput[2];
+		// Only read for the stage timings, owned by the application
+		const FrameGraph* frameGraph;
+
+		void clearSelection();
 	public:
 		GUI(std::shared_ptr<MirielEngine::Core::Scene> s);
 		~GUI();
 		void generateFrame(const ImGuiImplementationFunction& implFunction);
+		void setFrameGraph(const FrameGraph* graph);
 	};
 };
\ No newline at end of file
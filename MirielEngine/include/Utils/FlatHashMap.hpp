@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace MirielEngine::Utils::DataStructures {
+	/*
+		Open addressing map with linear probing, every entry sits in one array so a lookup is a hash and usually a single
+		cache line. Meant for small trivially copyable keys like IDs. The hash is mixed again before use, std::hash of an
+		integer is the integer itself and the low bits alone would cluster badly.
+	*/
+	template <typename Key, typename Value, typename Hash = std::hash<Key>>
+	class FlatHashMap {
+		private:
+			struct Slot {
+				Key key;
+				Value value;
+				bool occupied = false;
+			};
+
+			std::vector<Slot> _slots;
+			size_t _size = 0;
+			Hash _hash;
+
+			size_t slotFor(const Key& key) const {
+				uint64_t h = static_cast<uint64_t>(_hash(key)) * 0x9E3779B97F4A7C15ull;
+				return static_cast<size_t>(h ^ (h >> 32)) & (_slots.size() - 1);
+			}
+
+			size_t findSlot(const Key& key) const {
+				if (_slots.empty()) { return SIZE_MAX; }
+				for (size_t i = slotFor(key);; i = (i + 1) & (_slots.size() - 1)) {
+					if (!_slots[i].occupied) { return SIZE_MAX; }
+					if (_slots[i].key == key) { return i; }
+				}
+			}
+
+			void grow(size_t capacity) {
+				std::vector<Slot> old = std::move(_slots);
+				_slots.assign(capacity, Slot{});
+				for (Slot& slot : old) {
+					if (!slot.occupied) { continue; }
+					size_t i = slotFor(slot.key);
+					while (_slots[i].occupied) { i = (i + 1) & (_slots.size() - 1); }
+					_slots[i] = std::move(slot);
+				}
+			}
+		public:
+			size_t size() const { return _size; }
+			bool empty() const { return _size == 0; }
+
+			void reserve(size_t count) {
+				// Kept at most 3/4 full so probes stay short
+				size_t capacity = 16;
+				while (capacity * 3 < count * 4) { capacity *= 2; }
+				if (capacity > _slots.size()) { grow(capacity); }
+			}
+
+			void clear() {
+				_slots.clear();
+				_size = 0;
+			}
+
+			Value* find(const Key& key) {
+				size_t i = findSlot(key);
+				return i == SIZE_MAX ? nullptr : &_slots[i].value;
+			}
+
+			const Value* find(const Key& key) const {
+				size_t i = findSlot(key);
+				return i == SIZE_MAX ? nullptr : &_slots[i].value;
+			}
+
+			bool contains(const Key& key) const { return findSlot(key) != SIZE_MAX; }
+
+			// Returns false and leaves the old value alone if key is already in
+			bool insert(const Key& key, const Value& value) {
+				reserve(_size + 1);
+				size_t i = slotFor(key);
+				while (_slots[i].occupied) {
+					if (_slots[i].key == key) { return false; }
+					i = (i + 1) & (_slots.size() - 1);
+				}
+				_slots[i].key = key;
+				_slots[i].value = value;
+				_slots[i].occupied = true;
+				_size++;
+				return true;
+			}
+
+			bool erase(const Key& key) {
+				size_t i = findSlot(key);
+				if (i == SIZE_MAX) { return false; }
+
+				// Shifts later entries of the run back instead of leaving a tombstone, so lookups never probe past dead slots
+				size_t mask = _slots.size() - 1;
+				size_t hole = i;
+				for (size_t j = (i + 1) & mask; _slots[j].occupied; j = (j + 1) & mask) {
+					size_t home = slotFor(_slots[j].key);
+					// j can fill the hole unless its home slot lies cyclically in (hole, j]
+					bool stays = hole <= j ? (hole < home && home <= j) : (hole < home || home <= j);
+					if (stays) { continue; }
+					_slots[hole] = std::move(_slots[j]);
+					hole = j;
+				}
+				_slots[hole].occupied = false;
+				_size--;
+				return true;
+			}
+
+			template <typename Function>
+			void forEach(Function&& function) const {
+				for (const Slot& slot : _slots) {
+					if (slot.occupied) { function(slot.key, slot.value); }
+				}
+			}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Utils/JobSystem.hpp"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include <initializer_list>
+
+namespace MirielEngine::Utils {
+	// Bit flags so a stage's reads and writes can be kept as masks
+	enum class FrameResource : uint32_t {
+		Window = 1,				// glfw events and the swap chain
+		Scene = 2,				// objects, instances, lights, camera
+		GPUResources = 4,		// buffers, programs and textures owned by the backend core
+		DrawList = 8,			// the sorted draws and matrices prepared for this frame
+		ImGuiFrame = 16,		// the ImGui context while widgets are being built
+		ImGuiDrawData = 32,		// the output of ImGui::Render
+		Framebuffer = 64		// whatever is currently being drawn into
+	};
+
+	enum class StageAffinity : uint8_t {
+		MainThread,				// touches GL, glfw or NFD
+		Worker					// CPU only, can run on the job system alongside main thread stages
+	};
+
+	const char* getStageAffinityName(StageAffinity affinity);
+
+	struct FrameStage {
+		std::string name;
+		uint32_t reads;
+		uint32_t writes;
+		StageAffinity affinity;
+		std::function<void()> work;
+		// Earlier stages this one has to wait for, filled in by addStage
+		std::vector<size_t> dependencies;
+		std::unique_ptr<JobCounter> counter;
+
+		double lastMilliseconds;
+		double averageMilliseconds;
+	};
+
+	/*
+		Stages are added in the order they would run single threaded. A stage depends on every earlier stage that
+		writes something it reads or writes, or reads something it writes, so the declaration order is always a
+		valid schedule. execute walks the stages in that order: main thread stages run inline once their
+		dependencies are done, worker stages are submitted to the job system as priority jobs and the main thread
+		carries on with whatever comes next until it reaches a stage that needs them, running it itself if no
+		worker has got to it yet.
+	*/
+	class FrameGraph {
+		private:
+			std::vector<FrameStage> stages;
+			double lastFrameMilliseconds;
+		public:
+			FrameGraph();
+			~FrameGraph() = default;
+			FrameGraph(const FrameGraph&) = delete;
+			FrameGraph& operator=(const FrameGraph&) = delete;
+
+			void addStage(const std::string& name, std::initializer_list<FrameResource> reads, std::initializer_list<FrameResource> writes,
+						StageAffinity affinity, std::function<void()> work);
+			// Runs every stage once, must be called from the main thread
+			void execute();
+
+			const std::vector<FrameStage>& getStages() const { return stages; }
+			double getLastFrameMilliseconds() const { return lastFrameMilliseconds; }
+	};
+}
\ No newline at end of file
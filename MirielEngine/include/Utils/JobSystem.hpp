@@ -0,0 +1,183 @@
+#pragma once
+
+#include "Utils/MirielEngineLogger.hpp"
+#include "Utils/ThreadsafeQueue.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <functional>
+#include <algorithm>
+
+// Number of worker threads, 0 picks one per core minus the main and logging threads
+#ifndef MIRIEL_JOB_WORKERS
+#define MIRIEL_JOB_WORKERS 0
+#endif
+
+namespace MirielEngine::Utils {
+	class JobSystem;
+	class JobCounter;
+
+	struct Job {
+		std::function<void()> task;
+		JobCounter* counter = nullptr;
+	};
+
+	/*
+		Counts jobs that haven't finished yet. Jobs are added to a counter when they are submitted and taken off
+		when they finish, continuations added with JobSystem::then are submitted once it reaches zero. A counter
+		can be reused after it hits zero, but it has to outlive every job that was submitted with it.
+	*/
+	class JobCounter {
+		private:
+			friend class JobSystem;
+			std::atomic<uint32_t> pending{ 0 };
+			std::mutex continuationMtx;
+			std::vector<Job> continuations;
+		public:
+			JobCounter() = default;
+			JobCounter(const JobCounter&) = delete;
+			JobCounter& operator=(const JobCounter&) = delete;
+
+			bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+	};
+
+	/*
+		Each worker owns a deque, it pushes and pops its own work at the back and other workers steal from the
+		front when they run dry. Jobs submitted from outside the pool are dealt out round robin. Anything that
+		has to touch GL (or glfw/NFD) goes on the main thread queue instead, which the main loop drains with
+		pumpMainThread once a frame. Priority jobs share one queue that every worker checks before its own, for
+		short work something is about to block on (frame stages) that can't sit behind a model import.
+	*/
+	class JobSystem {
+		private:
+			struct WorkerQueue {
+				std::mutex mtx;
+				std::deque<Job> jobs;
+			};
+
+			static JobSystem* instance;
+			static std::mutex mtx;
+
+			std::vector<std::unique_ptr<WorkerQueue>> queues;
+			std::vector<std::thread> workers;
+			DataStructures::ThreadsafeQueue<Job> mainThreadJobs;
+			std::mutex priorityMtx;
+			std::deque<Job> priorityJobs;
+			std::thread::id mainThreadID;
+
+			std::atomic<bool> running;
+			std::atomic<size_t> nextQueue{ 0 };
+			std::atomic<int64_t> queuedJobs{ 0 };
+			// Same sleep/wake handshake as the logging thread, idle workers wait on epoch and submitters only wake them if one is asleep
+			std::atomic<uint32_t> epoch{ 0 };
+			std::atomic<uint32_t> sleepingWorkers{ 0 };
+
+			JobSystem();
+			JobSystem(const JobSystem& obj) = delete;
+
+			void workerLoop(size_t index);
+			void pushJob(Job&& job);
+			bool popJob(size_t index, Job& out);
+			bool popPriorityJob(Job& out);
+			bool stealJob(size_t thief, Job& out);
+			bool tryRunOne();
+			void runJob(Job& job);
+			void finishJob(JobCounter* counter);
+			void wake();
+		public:
+			~JobSystem();
+
+			static JobSystem* getInstance();
+
+			size_t getWorkerCount() const { return workers.size(); }
+			bool isMainThread() const { return std::this_thread::get_id() == mainThreadID; }
+
+			void submit(std::function<void()> task, JobCounter* counter = nullptr);
+			// Runs ahead of every normal job, keep it short, there's only the one queue
+			void submitPriority(std::function<void()> task, JobCounter* counter = nullptr);
+			// Runs one queued priority job on the calling thread, false if there were none
+			bool runPriorityJob();
+			// Submits task once counter reaches zero, straight away if it already has
+			void then(JobCounter& counter, std::function<void()> task, JobCounter* taskCounter = nullptr);
+			// Runs other jobs (and main thread jobs when called from the main thread) until counter reaches zero
+			void wait(JobCounter& counter);
+
+			// GL only work, runs on the main thread the next time pumpMainThread is called
+			void runOnMainThread(std::function<void()> task, JobCounter* counter = nullptr);
+			// Returns how many main thread jobs were run
+			size_t pumpMainThread();
+
+			// Holds counter open for work that isn't a single job (a coroutine hopping between threads), release runs its continuations
+			void retainCounter(JobCounter& counter);
+			void releaseCounter(JobCounter& counter);
+
+			/*
+				Calls body(i) for every i in [begin, end), split into chunks of grainSize, and returns once all of them
+				have run. The caller and up to one helper job per worker take chunks off a shared counter until there
+				are none left, so the caller only ever waits on chunks that are already running. It never picks up
+				unrelated jobs while it waits, a frame stage calling this can't end up stuck in a model import. Helpers
+				that only get to run after the last chunk is taken find nothing to do and leave without touching body.
+			*/
+			template <typename Body>
+			void parallel_for(size_t begin, size_t end, size_t grainSize, const Body& body) {
+				if (begin >= end) { return; }
+				grainSize = std::max<size_t>(grainSize, 1);
+
+				struct SharedChunks {
+					size_t begin;
+					size_t end;
+					size_t grainSize;
+					size_t chunkCount;
+					const Body* body;
+					std::atomic<size_t> next{ 0 };
+					std::atomic<size_t> finished{ 0 };
+				};
+
+				auto chunks = std::make_shared<SharedChunks>();
+				chunks->begin = begin;
+				chunks->end = end;
+				chunks->grainSize = grainSize;
+				chunks->chunkCount = (end - begin + grainSize - 1) / grainSize;
+				chunks->body = &body;
+
+				// Runs chunks until they're all claimed, finished is counted even when body throws so the caller can't hang on it
+				auto RunChunks = [](SharedChunks& shared) {
+					for (size_t chunk = shared.next.fetch_add(1, std::memory_order_relaxed); chunk < shared.chunkCount;
+						 chunk = shared.next.fetch_add(1, std::memory_order_relaxed)) {
+						struct FinishChunk {
+							std::atomic<size_t>& finished;
+							~FinishChunk() { finished.fetch_add(1, std::memory_order_release); }
+						} finish{ shared.finished };
+
+						size_t chunkBegin = shared.begin + chunk * shared.grainSize;
+						size_t chunkEnd = std::min(shared.end, chunkBegin + shared.grainSize);
+						for (size_t i = chunkBegin; i < chunkEnd; i++) { (*shared.body)(i); }
+					}
+				};
+
+				size_t helpers = std::min(workers.size(), chunks->chunkCount - 1);
+				for (size_t i = 0; i < helpers; i++) {
+					submit([chunks, RunChunks]() { RunChunks(*chunks); });
+				}
+
+				size_t claimed = chunks->chunkCount;
+				try {
+					RunChunks(*chunks);
+				} catch (...) {
+					// Stops handing out chunks, the ones already claimed still point at body and have to finish first
+					claimed = std::min(chunks->next.exchange(chunks->chunkCount, std::memory_order_relaxed), chunks->chunkCount);
+					while (chunks->finished.load(std::memory_order_acquire) < claimed) { std::this_thread::yield(); }
+					throw;
+				}
+				while (chunks->finished.load(std::memory_order_acquire) < claimed) { std::this_thread::yield(); }
+			}
+
+			void cleanup();
+	};
+
+	inline JobSystem * const GlobalJobSystem = JobSystem::getInstance();
+}
\ No newline at end of file
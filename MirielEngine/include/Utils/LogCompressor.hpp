@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace MirielEngine::Utils {
+	/*
+		Small LZ77 compressor for rotated log segments, logs are mostly repeated prefixes and format strings so a
+		greedy matcher with a 4 byte hash already gets most of the way there.
+
+		Compressed file layout, little endian:
+			header:		"MLZ1" u64 uncompressed size
+			block:		u32 raw size u32 compressed size bytes		(blocks of up to compressionBlockSize raw bytes)
+
+		Inside a block each sequence is a token (high nibble literal count, low nibble match length - 4, 15 means
+		more length bytes follow, each adding up to 255), the literals, then a u16 match offset. The last sequence
+		of a block only has literals.
+	*/
+	constexpr char compressedLogMagic[4] = { 'M', 'L', 'Z', '1' };
+	constexpr const char* compressedLogExtension = ".mlz";
+	constexpr size_t compressionBlockSize = 1024 * 1024;
+
+	std::string compressLogData(std::string_view input);
+	// Returns false if input isn't a compressed log or is damaged, out keeps whatever decoded before that
+	bool decompressLogData(std::string_view input, std::string& out);
+
+	// Writes inputName + ".mlz" and deletes inputName once the compressed copy is complete, returns the compressed size or 0 on failure
+	uint64_t compressLogFile(const std::string& inputName);
+	bool decompressLogFile(const std::string& inputName, const std::string& outputName);
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace MirielEngine::Utils::DataStructures {
+	/*
+		Bounded lock-free ring buffer, many threads push. Normally one consumer thread pops, but tryPop claims its slot
+		with a CAS so any thread may call it: a producer that finds the buffer full can pop the oldest entry itself
+		(the logger's DropOldest policy does this). Each pop hands its slot to exactly one reader, entries still come
+		out in push order, but with several poppers the readers can finish in any order.
+
+		Every slot is allocated once in the constructor and reused forever, producers write directly into
+		the slot they claim so a push never touches the heap or a mutex. Each slot carries a sequence number
+		that tells producers and poppers whether it is free, being written, or ready to be read. A slot being
+		read stays unavailable to producers until its reader returns, the buffer just looks full until then.
+		Capacity is rounded up to a power of two so the index wrap is a mask instead of a modulo.
+	*/
+	template <typename T>
+	class MPSCRingBuffer {
+		private:
+			static constexpr size_t cacheLineSize = 64;
+
+			struct alignas(cacheLineSize) Slot {
+				std::atomic<size_t> sequence;
+				T item;
+			};
+
+			std::unique_ptr<Slot[]> _slots;
+			size_t _mask;
+
+			// Kept on separate cache lines so producers and the consumer don't fight over the same line
+			alignas(cacheLineSize) std::atomic<size_t> _tail;
+			alignas(cacheLineSize) std::atomic<size_t> _head;
+
+			static size_t roundUpToPowerOfTwo(size_t n) {
+				size_t p = 2;
+				while (p < n) { p <<= 1; }
+				return p;
+			}
+		public:
+			explicit MPSCRingBuffer(size_t capacity) {
+				size_t size = roundUpToPowerOfTwo(capacity);
+				_slots = std::make_unique<Slot[]>(size);
+				_mask = size - 1;
+				for (size_t i = 0; i < size; i++) {
+					_slots[i].sequence.store(i, std::memory_order_relaxed);
+				}
+				_tail.store(0, std::memory_order_relaxed);
+				_head.store(0, std::memory_order_relaxed);
+			}
+
+			~MPSCRingBuffer() = default;
+			MPSCRingBuffer(const MPSCRingBuffer&) = delete;
+			MPSCRingBuffer& operator=(const MPSCRingBuffer&) = delete;
+
+			// writer(T&) fills the claimed slot in place, returns false without calling writer when the buffer is full
+			template <typename Writer>
+			bool tryPush(Writer&& writer) {
+				size_t pos = _tail.load(std::memory_order_relaxed);
+				while (true) {
+					Slot& slot = _slots[pos & _mask];
+					size_t seq = slot.sequence.load(std::memory_order_acquire);
+					intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+					if (diff == 0) {
+						if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+							writer(slot.item);
+							slot.sequence.store(pos + 1, std::memory_order_release);
+							return true;
+						}
+					} else if (diff < 0) {
+						return false;
+					} else {
+						pos = _tail.load(std::memory_order_relaxed);
+					}
+				}
+			}
+
+			// reader(T&) consumes the oldest slot in place, returns false when nothing is ready. Safe from any thread
+			template <typename Reader>
+			bool tryPop(Reader&& reader) {
+				size_t pos = _head.load(std::memory_order_relaxed);
+				while (true) {
+					Slot& slot = _slots[pos & _mask];
+					size_t seq = slot.sequence.load(std::memory_order_acquire);
+					intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+					if (diff == 0) {
+						// CAS rather than a plain store so a producer may also evict the oldest entry if it has to
+						if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+							reader(slot.item);
+							slot.sequence.store(pos + _mask + 1, std::memory_order_release);
+							return true;
+						}
+					} else if (diff < 0) {
+						return false;
+					} else {
+						pos = _head.load(std::memory_order_relaxed);
+					}
+				}
+			}
+
+			// Both of these are snapshots, they can be stale by the time the caller looks at them
+			size_t size() const {
+				size_t tail = _tail.load(std::memory_order_acquire);
+				size_t head = _head.load(std::memory_order_acquire);
+				return tail > head ? tail - head : 0;
+			}
+
+			bool empty() const {
+				return size() == 0;
+			}
+
+			size_t capacity() const {
+				return _mask + 1;
+			}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace MirielEngine::Utils {
+	/*
+		Owns a memory mapped view of a whole file. Read write mappings are backed by the file itself, so the
+		kernel writes the pages out even if the process dies without unmapping.
+	*/
+	class MappedFile {
+		private:
+			void* data = nullptr;
+			size_t size = 0;
+			bool writable = false;
+#if _WIN64
+			void* fileHandle = nullptr;
+			void* mappingHandle = nullptr;
+#else
+			int fileDescriptor = -1;
+#endif
+		public:
+			MappedFile() = default;
+			~MappedFile();
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			// Creates the file if needed and resizes it to exactly size bytes
+			bool openReadWrite(const std::string& path, size_t size);
+			bool openReadOnly(const std::string& path);
+			// Asks the OS to start writing dirty pages back, doesn't wait for it
+			void flushAsync();
+			void close();
+
+			bool isOpen() const { return data != nullptr; }
+			void* getData() const { return data; }
+			size_t getSize() const { return size; }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <cstdint>
+#include <cstring>
+
+#include "Utils/MappedFile.hpp"
+#include "Utils/MirielEngineLogFormat.hpp"
+
+// Records the mapped ring keeps, 256 bytes each. Only the newest this many survive to the Logs/ file, older ones are overwritten
+#ifndef MIRIEL_MAPPED_LOG_SLOTS
+#define MIRIEL_MAPPED_LOG_SLOTS 16384
+#endif
+
+namespace MirielEngine::Utils {
+	/*
+		Fixed size log ring that lives in a memory mapped file.
+
+		Producers claim a slot with one atomic add on the header and write the record straight into the mapping,
+		there is no logging thread and no flush. When the ring wraps the oldest records are overwritten, so the file
+		only ever holds the last slotCount committed records, a crash or a clean exit alike. If the process dies the
+		pages are still owned by the kernel and recover() turns them back into a normal text log on the next start,
+		with a line saying how many earlier records were overwritten.
+
+		File layout:
+			header
+			format table	(format strings are copied in the first time their ID is used, the IDs don't survive a restart)
+			slots			(slotCount records of slotSize bytes)
+	*/
+	class MappedLogRing {
+		public:
+			static constexpr uint32_t version = 1;
+			static constexpr size_t slotSize = 256;
+			static constexpr size_t slotCount = MIRIEL_MAPPED_LOG_SLOTS;
+			static constexpr size_t formatTableSize = 128 * 1024;
+
+			struct Header {
+				char magic[4];
+				uint32_t version;
+				uint64_t slotSize;
+				uint64_t slotCount;
+				uint64_t formatTableSize;
+				uint64_t tail;				// next position to claim, only touched through atomic_ref
+				uint64_t formatTableUsed;	// bytes used in the format table, guarded by formatMtx
+			};
+
+			struct Slot {
+				uint64_t sequence;	// position + 1 once the record is complete, 0 while it is being written
+				int64_t time;
+				uint16_t formatID;
+				uint8_t level;
+				uint8_t category;
+				uint32_t length;
+			};
+
+			static constexpr size_t payloadSize = slotSize - sizeof(Slot);
+			static constexpr size_t fileSize = sizeof(Header) + formatTableSize + slotSize * slotCount;
+		private:
+			MappedFile file;
+			Header* header = nullptr;
+			char* formatTable = nullptr;
+			char* slots = nullptr;
+
+			std::mutex formatMtx;
+			std::atomic<uint64_t> formatPersisted[LogFormatRegistry::maxFormats / 64] = {};
+
+			void persistFormat(uint16_t formatID);
+			Slot* claim(uint64_t& position);
+		public:
+			MappedLogRing() = default;
+			~MappedLogRing() = default;
+			MappedLogRing(const MappedLogRing&) = delete;
+			MappedLogRing& operator=(const MappedLogRing&) = delete;
+
+			// Starts a fresh ring, anything already in the file is thrown away so recover it first
+			bool create(const std::string& path);
+			void close();
+			bool isOpen() const { return header != nullptr; }
+
+			// Returns true when the record took the slot of an older one that never made it out of the ring
+			template <typename Encoder>
+			bool write(int64_t time, uint16_t formatID, LogLevel level, LogCategory category, size_t size, const Encoder& encoder) {
+				uint64_t bit = uint64_t(1) << (formatID % 64);
+				if ((formatPersisted[formatID / 64].load(std::memory_order_acquire) & bit) == 0) {
+					persistFormat(formatID);
+				}
+
+				uint64_t position;
+				Slot* slot = claim(position);
+				slot->time = time;
+				slot->formatID = formatID;
+				slot->level = static_cast<uint8_t>(level);
+				slot->category = static_cast<uint8_t>(category);
+
+				char* payload = reinterpret_cast<char*>(slot + 1);
+				if (size <= payloadSize) {
+					encoder(payload);
+					slot->length = static_cast<uint32_t>(size);
+				} else {
+					// Too big for a slot, encode on the side and keep what fits, the decoder prints {} for a cut argument
+					thread_local std::string scratch;
+					scratch.resize(size);
+					encoder(scratch.data());
+					std::memcpy(payload, scratch.data(), payloadSize);
+					slot->length = static_cast<uint32_t>(payloadSize);
+				}
+
+				std::atomic_ref<uint64_t>(slot->sequence).store(position + 1, std::memory_order_release);
+				return position >= slotCount;
+			}
+
+			// Converts a ring file left behind by an earlier run into a text log, returns false if there was nothing usable
+			static bool recover(const std::string& ringPath, const std::string& outputName);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/*
+	Deferred formatting for the logger.
+
+	Call sites hand over a format string ID plus the raw arguments, the logger thread (or the -d decoder for
+	binary logs) does the actual formatting later. Format strings use {} for each argument, in order.
+
+	MIRIEL_LOG_FORMAT_ID registers a string literal once per call site, every call after the first is a
+	single guarded static load.
+*/
+#define MIRIEL_LOG_FORMAT_ID(fmt) ([]() -> uint16_t { static const uint16_t id = MirielEngine::Utils::LogFormatRegistry::registerFormat(fmt); return id; }())
+
+// The extra expansion step is for MSVC's preprocessor, which otherwise hands __VA_ARGS__ over as one argument
+#define MIRIEL_LOG_EXPAND(x) x
+#define MIRIEL_LOG_FIRST_IMPL(first, ...) first
+#define MIRIEL_LOG_FIRST(...) MIRIEL_LOG_EXPAND(MIRIEL_LOG_FIRST_IMPL(__VA_ARGS__, unused))
+
+/*
+	Lowest level that gets compiled in (0 Trace, 1 Debug, 2 Info, 3 Warning, 4 Error, 5 Fatal) and a mask of the
+	categories that get compiled in (1 Core, 2 Loader, 4 OpenGL, 8 GUI). Calls below the level or outside the mask
+	are discarded by if constexpr, so their arguments are never evaluated. Release builds drop Trace and Debug.
+*/
+#ifndef MIRIEL_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define MIRIEL_LOG_MIN_LEVEL 2
+#else
+#define MIRIEL_LOG_MIN_LEVEL 0
+#endif
+#endif
+
+#ifndef MIRIEL_LOG_CATEGORIES
+#define MIRIEL_LOG_CATEGORIES 0xF
+#endif
+
+// MIRIEL_LOG(Debug, Loader, "Loading in Object: {}", objectName);
+#define MIRIEL_LOG(level, category, ...) \
+	do { \
+		if constexpr (MirielEngine::Utils::isLogEnabled(MirielEngine::Utils::LogLevel::level, MirielEngine::Utils::LogCategory::category)) { \
+			if (MirielEngine::Utils::GlobalLogger->shouldLog(MirielEngine::Utils::LogLevel::level, MirielEngine::Utils::LogCategory::category)) { \
+				MirielEngine::Utils::GlobalLogger->logFormat(MIRIEL_LOG_FORMAT_ID(MIRIEL_LOG_FIRST(__VA_ARGS__)), \
+					MirielEngine::Utils::LogLevel::level, MirielEngine::Utils::LogCategory::category, __VA_ARGS__); \
+			} \
+		} \
+	} while (0)
+
+namespace MirielEngine::Utils {
+	enum class LogLevel : uint8_t {
+		Trace,
+		Debug,
+		Info,
+		Warning,
+		Error,
+		Fatal
+	};
+
+	// Bit flags so the compiled in and runtime filters can be masks
+	enum class LogCategory : uint8_t {
+		Core = 1,
+		Loader = 2,
+		OpenGL = 4,
+		GUI = 8
+	};
+
+	constexpr size_t logLevelCount = 6;
+	constexpr size_t logCategoryCount = 4;
+
+	constexpr bool isLogEnabled(LogLevel level, LogCategory category) {
+#if MIRIEL_LOG_MIN_LEVEL > 0
+		if (static_cast<uint8_t>(level) < MIRIEL_LOG_MIN_LEVEL) { return false; }
+#else
+		// Every level passes, comparing against 0 would only warn in every file that logs
+		(void)level;
+#endif
+		return (MIRIEL_LOG_CATEGORIES & static_cast<uint8_t>(category)) != 0;
+	}
+
+	const char* getLogLevelName(LogLevel level);
+	const char* getLogCategoryName(LogCategory category);
+
+	class LogFormatRegistry {
+		public:
+			static constexpr uint16_t maxFormats = 4096;
+			// ID 0 is reserved for plain log() calls, it formats a single string argument
+			static constexpr uint16_t plainMessageID = 0;
+
+			static uint16_t registerFormat(const char* fmt);
+			static std::string_view getFormat(uint16_t id);
+			static uint16_t count();
+	};
+
+	// Tags written in front of every encoded argument
+	enum class LogArgumentType : uint8_t {
+		SignedInt = 'i',
+		UnsignedInt = 'u',
+		Float = 'd',
+		Bool = 'b',
+		Char = 'c',
+		String = 's'
+	};
+
+	template <typename T>
+	constexpr bool IsLogStringArgument = std::is_convertible_v<const T&, std::string_view>;
+
+	template <typename T>
+	size_t encodedArgumentSize(const T& arg) {
+		if constexpr (IsLogStringArgument<T>) {
+			return 1 + sizeof(uint32_t) + std::string_view(arg).size();
+		} else if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, char>) {
+			return 2;
+		} else {
+			static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "Unsupported Logging Argument Type.");
+			return 1 + sizeof(uint64_t);
+		}
+	}
+
+	template <typename T>
+	char* encodeArgument(char* out, const T& arg) {
+		if constexpr (IsLogStringArgument<T>) {
+			std::string_view s(arg);
+			uint32_t length = static_cast<uint32_t>(s.size());
+			*out++ = static_cast<char>(LogArgumentType::String);
+			std::memcpy(out, &length, sizeof(length));
+			out += sizeof(length);
+			std::memcpy(out, s.data(), length);
+			return out + length;
+		} else if constexpr (std::is_same_v<T, bool>) {
+			*out++ = static_cast<char>(LogArgumentType::Bool);
+			*out++ = arg ? 1 : 0;
+			return out;
+		} else if constexpr (std::is_same_v<T, char>) {
+			*out++ = static_cast<char>(LogArgumentType::Char);
+			*out++ = arg;
+			return out;
+		} else if constexpr (std::is_floating_point_v<T>) {
+			double v = static_cast<double>(arg);
+			*out++ = static_cast<char>(LogArgumentType::Float);
+			std::memcpy(out, &v, sizeof(v));
+			return out + sizeof(v);
+		} else if constexpr (std::is_enum_v<T> || std::is_signed_v<T>) {
+			int64_t v = static_cast<int64_t>(arg);
+			*out++ = static_cast<char>(LogArgumentType::SignedInt);
+			std::memcpy(out, &v, sizeof(v));
+			return out + sizeof(v);
+		} else {
+			uint64_t v = static_cast<uint64_t>(arg);
+			*out++ = static_cast<char>(LogArgumentType::UnsignedInt);
+			std::memcpy(out, &v, sizeof(v));
+			return out + sizeof(v);
+		}
+	}
+
+	// Replaces each {} in fmt with the next encoded argument and appends the result to out
+	void appendFormattedMessage(std::string& out, std::string_view fmt, std::string_view encodedArgs);
+
+	// Appends "HH:MM:SS: " for a system_clock time in nanoseconds, caches the last second it converted
+	class LogTimestampFormatter {
+		private:
+			int64_t cachedSecond = -1;
+			char cachedPrefix[16] = {};
+			size_t cachedPrefixLength = 0;
+		public:
+			void append(std::string& out, int64_t timeNanoseconds);
+	};
+
+	// One finished line of the text log, "HH:MM:SS: message" with the level in front of anything that isn't Info
+	void appendLogLine(std::string& out, LogTimestampFormatter& timestamp, int64_t timeNanoseconds, LogLevel level, LogCategory category,
+						std::string_view fmt, std::string_view encodedArgs);
+
+	/*
+		Binary log layout, everything little endian:
+			header:		"MLOG" u32 version
+			format:		'F' u16 id u32 length bytes			(written the first time an ID shows up in the file)
+			message:	'M' i64 time u16 id u8 level u8 category u32 length args
+	*/
+	constexpr char binaryLogMagic[4] = { 'M', 'L', 'O', 'G' };
+	constexpr uint32_t binaryLogVersion = 2;
+
+	// Turns a binary log back into the normal text format, returns false if input isn't a binary log
+	bool decodeBinaryLog(const std::string& inputName, const std::string& outputName);
+}
\ No newline at end of file
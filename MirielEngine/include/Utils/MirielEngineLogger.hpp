@@ -1,42 +1,244 @@
 #pragma once
 
 #include "CustomErrors/MirielEngineErrors.hpp"
+#include "Utils/MPSCRingBuffer.hpp"
+#include "Utils/MirielEngineLogFormat.hpp"
+#include "Utils/MappedLogRing.hpp"
 #include "Utils/ThreadsafeQueue.hpp"
 
 #include <memory>
+#include <atomic>
 #include <mutex>
 #include <chrono>
 #include <thread>
 #include <string>
+#include <string_view>
+
+// Set to 1 to write compact binary .mlog files instead of text, turn them back into text with: MirielEngine -d <file>
+#ifndef MIRIEL_BINARY_LOGGING
+#define MIRIEL_BINARY_LOGGING 0
+#endif
+
+// Set to 1 to log into a memory mapped ring file (Logs/active.mring) instead of the logging thread, nothing is lost on a
+// crash but only the newest MIRIEL_MAPPED_LOG_SLOTS records are kept, the queue keeps the whole session
+#ifndef MIRIEL_MAPPED_LOGGING
+#define MIRIEL_MAPPED_LOGGING 0
+#endif
+
+/*
+	Slots in the logger queue (rounded up to a power of two) and what happens when a burst fills it:
+		0 Block			producers wait for the logging thread to make room
+		1 DropNewest	the message being logged is thrown away
+		2 DropOldest	the oldest queued message is thrown away to make room
+		3 Sample		only 1 in MIRIEL_LOG_SAMPLE_RATE messages is kept while full, those wait like Block
+	The policy and sample rate can be changed at runtime, the capacity can't. Doesn't apply to MIRIEL_MAPPED_LOGGING,
+	the ring always overwrites its oldest records.
+*/
+#ifndef MIRIEL_LOG_QUEUE_CAPACITY
+#define MIRIEL_LOG_QUEUE_CAPACITY 4096
+#endif
+
+#ifndef MIRIEL_LOG_BACKPRESSURE
+#define MIRIEL_LOG_BACKPRESSURE 0
+#endif
+
+#ifndef MIRIEL_LOG_SAMPLE_RATE
+#define MIRIEL_LOG_SAMPLE_RATE 8
+#endif
 
 namespace MirielEngine::Utils {
+	enum class LogBackpressurePolicy : uint8_t {
+		Block,
+		DropNewest,
+		DropOldest,
+		Sample
+	};
+
+	constexpr size_t logBackpressurePolicyCount = 4;
+
+	const char* getLogBackpressurePolicyName(LogBackpressurePolicy policy);
+
+	/*
+		Lives inside a preallocated ring buffer slot. Holds a format ID and the encoded arguments rather than the
+		finished text, formatting happens on the logging thread. Short argument lists are stored in the inline
+		buffer so logging doesn't allocate, anything longer spills into overflow (which keeps its capacity between uses).
+	*/
 	struct LoggingMessage {
-		std::string msg;
-		std::chrono::system_clock::time_point time;
+		static constexpr size_t inlineSize = 224;
+
+		int64_t time;	// system_clock time since epoch in nanoseconds
+		uint16_t formatID;
+		LogLevel level;
+		LogCategory category;
+		size_t length;
+		char inlineArgs[inlineSize];
+		std::string overflow;
+
+		char* reserve(size_t size);
+		std::string_view args() const;
+	};
+
+	using LoggingBuffer = DataStructures::MPSCRingBuffer<LoggingMessage>;
+
+	/*
+		Wakes the logging thread only when it is actually asleep, producers check writerSleeping after pushing
+		and the logging thread checks the buffer again after setting it, so a wake up can't be lost between the two.
+	*/
+	struct LoggingSignal {
+		std::atomic<uint32_t> epoch{ 0 };
+		std::atomic<bool> writerSleeping{ false };
+
+		void notify();
+		void forceNotify();
+		void wait(uint32_t seenEpoch, const LoggingBuffer& buffer, const std::atomic<bool>& running);
+	};
+
+	/*
+		The active log is closed and renamed to "<name> - part N" once it passes either limit, the background
+		thread then compresses it to .mlz. Logs/ keeps at most logRetainedFiles files and logRetainedBytes bytes,
+		oldest are deleted first (the active log and the mapped ring are never touched).
+	*/
+	constexpr uint64_t logSegmentMaxBytes = 16 * 1024 * 1024;
+	constexpr int64_t logSegmentMaxSeconds = 30 * 60;
+	constexpr size_t logRetainedFiles = 32;
+	constexpr uint64_t logRetainedBytes = 256 * 1024 * 1024;
+
+	struct LoggingStats {
+		std::atomic<uint64_t> messagesWritten{ 0 };
+		std::atomic<uint64_t> batchesWritten{ 0 };
+		std::atomic<uint64_t> largestBatch{ 0 };
+		std::atomic<int64_t> worstLatencyMicroseconds{ 0 };	// time between log() and the batch containing it being written
+
+		std::atomic<uint64_t> segmentsRotated{ 0 };
+		std::atomic<uint64_t> segmentsCompressed{ 0 };
+		std::atomic<uint64_t> segmentBytesWritten{ 0 };		// bytes in the active segment
+		std::atomic<double> segmentMegabytesPerSecond{ 0.0 };	// active segment bytes over the time spent in write and flush
+		std::atomic<double> lastSegmentMegabytesPerSecond{ 0.0 };
+
+		std::atomic<uint64_t> messagesDropped{ 0 };
+		std::atomic<uint64_t> messagesBlocked{ 0 };	// messages whose producer had to wait for room
+		std::atomic<uint64_t> droppedUnreported{ 0 };	// drops the logging thread hasn't written a line about yet
 	};
 
-	void LoggingThreadFunction(std::shared_ptr<DataStructures::ThreadsafeQueue<std::unique_ptr<LoggingMessage>>> msgBuffer, const std::string& filename);
+	void LoggingThreadFunction(std::shared_ptr<LoggingBuffer> msgBuffer, std::shared_ptr<LoggingSignal> signal, const std::string& filename);
+	void LogCompressionThreadFunction(DataStructures::ThreadsafeQueue<std::string>& segments, const std::string& activeLog, LoggingStats& stats);
+	void enforceLogRetention(const std::string& activeLog);
 	std::string createLoggingFileName();
+	std::string getMappedRingFileName();
 
 	class Logger {
 		private:
-			std::shared_ptr<DataStructures::ThreadsafeQueue<std::unique_ptr<LoggingMessage>>> msgQueue;
+			static constexpr size_t queueCapacity = MIRIEL_LOG_QUEUE_CAPACITY;
+
+			std::shared_ptr<LoggingBuffer> msgQueue;
+			std::shared_ptr<LoggingSignal> msgSignal;
+			// Only set when MIRIEL_MAPPED_LOGGING is on and the ring file could be created, otherwise the queue is used.
+			// cleanup closes it but it stays allocated until the Logger goes away
+			std::unique_ptr<MappedLogRing> mappedRing;
 
 			static Logger* instance;
 			const std::string currentLog = createLoggingFileName();
 			static std::mutex mtx;
 
-			bool programRunning;
+			std::atomic<bool> programRunning;
+			// Producers between their programRunning check and the end of their write, cleanup waits for them before closing anything
+			std::atomic<uint32_t> activeProducers{ 0 };
 			std::thread loggingThread;
+			LoggingStats stats;
 
 			Logger();
 			Logger(const Logger& obj) = delete;
+
+			bool waitForRoom();
+			bool handleFullQueue(bool firstAttempt);
+			void recordDrop();
+
+			std::atomic<uint8_t> runtimeLevel;
+			std::atomic<uint8_t> runtimeCategories;
+			std::atomic<uint8_t> backpressurePolicy;
+			std::atomic<uint32_t> sampleRate;
+			std::atomic<uint64_t> sampleCounter{ 0 };
+
+			struct ProducerScope {
+				std::atomic<uint32_t>& count;
+				~ProducerScope() { count.fetch_sub(1, std::memory_order_release); }
+			};
+
+			template <typename Encoder>
+			void pushMessage(uint16_t formatID, LogLevel level, LogCategory category, size_t size, const Encoder& encoder) {
+				// Counted before programRunning is read, cleanup clears it before reading the count, so either cleanup
+				// waits for this write or this sees the logger shutting down and leaves the ring and queue alone
+				activeProducers.fetch_add(1, std::memory_order_seq_cst);
+				ProducerScope scope{ activeProducers };
+				if (!programRunning.load(std::memory_order_seq_cst)) {
+					recordDrop();
+					return;
+				}
+
+				int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+				if (mappedRing) {
+					// Wrapping over a record is the ring's only way of losing one, it counts the same as a drop
+					if (mappedRing->write(time, formatID, level, category, size, encoder)) {
+						stats.messagesDropped.fetch_add(1, std::memory_order_relaxed);
+					}
+					return;
+				}
+
+				auto WriteSlot = [&](LoggingMessage& slot) {
+					slot.time = time;
+					slot.formatID = formatID;
+					slot.level = level;
+					slot.category = category;
+					encoder(slot.reserve(size));
+				};
+
+				bool firstAttempt = true;
+				while (!msgQueue->tryPush(WriteSlot)) {
+					if (!handleFullQueue(firstAttempt)) {
+						recordDrop();
+						return;
+					}
+					firstAttempt = false;
+				}
+
+				msgSignal->notify();
+			}
 		public:
 			~Logger();
-			void log(const std::string& msg);
+			void log(std::string_view msg);
+
+			// Use through MIRIEL_LOG, fmt is only there so the macro can register it, the ID is what gets queued
+			template <typename... Args>
+			void logFormat(uint16_t formatID, LogLevel level, LogCategory category, [[maybe_unused]] const char* fmt, const Args&... args) {
+				size_t size = (size_t(0) + ... + encodedArgumentSize(args));
+				pushMessage(formatID, level, category, size, [&](char* out) {
+					((out = encodeArgument(out, args)), ...);
+					(void)out;
+				});
+			}
+
+			// Runtime filter on top of the compiled in one, the editor changes these while running
+			bool shouldLog(LogLevel level, LogCategory category) const {
+				return static_cast<uint8_t>(level) >= runtimeLevel.load(std::memory_order_relaxed) &&
+					(runtimeCategories.load(std::memory_order_relaxed) & static_cast<uint8_t>(category)) != 0;
+			}
+			void setRuntimeLevel(LogLevel level);
+			LogLevel getRuntimeLevel() const;
+			void setRuntimeCategoryEnabled(LogCategory category, bool enabled);
+			bool getRuntimeCategoryEnabled(LogCategory category) const;
+			void setBackpressurePolicy(LogBackpressurePolicy policy);
+			LogBackpressurePolicy getBackpressurePolicy() const;
+			// Keeps 1 in rate messages under the Sample policy, 0 is treated as 1
+			void setSampleRate(uint32_t rate);
+			uint32_t getSampleRate() const;
+
 			static Logger* getInstance();
 			std::string getCurrentLog();
 			bool getProgramRunning();
+			const std::atomic<bool>& getProgramRunningFlag();
+			LoggingStats& getStats();
+			// Returns once every producer that got past the programRunning check has finished its write
+			void waitForProducers();
 			void cleanup();
 	};
 
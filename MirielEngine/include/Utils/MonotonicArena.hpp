@@ -0,0 +1,58 @@
+#pragma once
+
+#include <memory_resource>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+// Size of the first block the arena takes from the heap, later blocks grow from there
+#ifndef MIRIEL_SCENE_ARENA_BLOCK_BYTES
+#define MIRIEL_SCENE_ARENA_BLOCK_BYTES (256 * 1024)
+#endif
+
+namespace MirielEngine::Utils {
+	/*
+		Hands out memory from a few big blocks and never gives any of it back on its own, release frees all of it in
+		one go. Meant for data that lives exactly as long as a scene: loading one makes a lot of small allocations that
+		would otherwise end up scattered over the heap and get freed one at a time when the scene goes away.
+
+		Model imports run on workers, so allocating takes a lock. Most of the time it's only held for a pointer bump.
+	*/
+	class MonotonicArena : public std::pmr::memory_resource {
+		private:
+			// Counts the blocks the arena takes from the heap, which is what it actually costs
+			class BlockResource : public std::pmr::memory_resource {
+				public:
+					std::atomic<size_t> reservedBytes{ 0 };
+					std::atomic<size_t> peakReservedBytes{ 0 };
+				private:
+					void* do_allocate(size_t bytes, size_t alignment) override;
+					void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+					bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+			};
+
+			BlockResource blockResource;
+			std::pmr::monotonic_buffer_resource blocks;
+			std::mutex arenaMtx;
+			std::atomic<size_t> usedBytes{ 0 };
+
+			void* do_allocate(size_t bytes, size_t alignment) override;
+			// Does nothing, memory only comes back through release
+			void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+		public:
+			MonotonicArena();
+			MonotonicArena(const MonotonicArena&) = delete;
+			MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+			// Nothing allocated from the arena can still be in use
+			void release();
+
+			// Asked for since the last release, freed memory included since it isn't reused
+			size_t getUsedBytes() const;
+			// Taken from the heap since the last release
+			size_t getReservedBytes() const;
+			// Most ever taken from the heap at once, kept across releases
+			size_t getPeakReservedBytes() const;
+	};
+}
\ No newline at end of file
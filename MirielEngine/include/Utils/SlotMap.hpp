@@ -0,0 +1,165 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <utility>
+
+namespace MirielEngine::Utils::DataStructures {
+	// Names one element for as long as it exists, a handle to something that has been removed never finds anything
+	struct SlotHandle {
+		static constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+
+		uint32_t index = None;
+		uint32_t generation = 0;
+
+		bool empty() const { return index == None; }
+		bool operator==(const SlotHandle& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+	};
+
+	/*
+		Maps handles to positions in a dense array someone else owns, so one table can sit in front of a single vector
+		(SlotMap) or a whole set of parallel ones (InstanceStore). Removing swaps the last element into the hole, the
+		owner does the same swap on its arrays so everything stays packed for iteration. Slots are reused through a free
+		list and bump their generation each time, which is what turns old handles stale.
+	*/
+	class HandleTable {
+		private:
+			struct Slot {
+				// Dense position while in use, next free slot while not
+				uint32_t dense;
+				uint32_t generation;
+			};
+
+			std::vector<Slot> slots;
+			std::vector<uint32_t> denseToSlot;
+			uint32_t freeHead = SlotHandle::None;
+		public:
+			static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+			size_t size() const { return denseToSlot.size(); }
+
+			void reserve(size_t count) {
+				slots.reserve(count);
+				denseToSlot.reserve(count);
+			}
+
+			// The new element goes at the end of the dense array
+			SlotHandle add() {
+				uint32_t slot;
+				if (freeHead != SlotHandle::None) {
+					slot = freeHead;
+					freeHead = slots[slot].dense;
+				} else {
+					slot = static_cast<uint32_t>(slots.size());
+					slots.push_back(Slot{ 0, 0 });
+				}
+
+				slots[slot].dense = static_cast<uint32_t>(denseToSlot.size());
+				denseToSlot.push_back(slot);
+				return SlotHandle{ slot, slots[slot].generation };
+			}
+
+			size_t indexOf(SlotHandle handle) const {
+				if (handle.index >= slots.size() || slots[handle.index].generation != handle.generation) { return npos; }
+				return slots[handle.index].dense;
+			}
+
+			SlotHandle handleAt(size_t dense) const {
+				uint32_t slot = denseToSlot[dense];
+				return SlotHandle{ slot, slots[slot].generation };
+			}
+
+			// Returns where the element was, the last element has to be moved there and the arrays shrunk by one. npos if stale
+			size_t remove(SlotHandle handle) {
+				size_t dense = indexOf(handle);
+				if (dense == npos) { return npos; }
+
+				uint32_t lastSlot = denseToSlot.back();
+				denseToSlot[dense] = lastSlot;
+				slots[lastSlot].dense = static_cast<uint32_t>(dense);
+				denseToSlot.pop_back();
+
+				slots[handle.index].generation++;
+				slots[handle.index].dense = freeHead;
+				freeHead = handle.index;
+				return dense;
+			}
+
+			// Every handle given out so far goes stale
+			void clear() {
+				for (uint32_t slot : denseToSlot) {
+					slots[slot].generation++;
+					slots[slot].dense = freeHead;
+					freeHead = slot;
+				}
+				denseToSlot.clear();
+			}
+	};
+
+	// Dense vector of T behind a HandleTable, O(1) insert, remove and lookup while iterating stays a plain array walk
+	template <typename T>
+	class SlotMap {
+		private:
+			HandleTable _handles;
+			std::vector<T> _values;
+		public:
+			using iterator = typename std::vector<T>::iterator;
+			using const_iterator = typename std::vector<T>::const_iterator;
+
+			size_t size() const { return _values.size(); }
+			bool empty() const { return _values.empty(); }
+
+			void reserve(size_t count) {
+				_handles.reserve(count);
+				_values.reserve(count);
+			}
+
+			void clear() {
+				_handles.clear();
+				_values.clear();
+			}
+
+			SlotHandle insert(T value) {
+				SlotHandle handle = _handles.add();
+				_values.push_back(std::move(value));
+				return handle;
+			}
+
+			bool remove(SlotHandle handle) {
+				size_t dense = _handles.remove(handle);
+				if (dense == HandleTable::npos) { return false; }
+				if (dense != _values.size() - 1) { _values[dense] = std::move(_values.back()); }
+				_values.pop_back();
+				return true;
+			}
+
+			bool contains(SlotHandle handle) const { return _handles.indexOf(handle) != HandleTable::npos; }
+			size_t indexOf(SlotHandle handle) const { return _handles.indexOf(handle); }
+			SlotHandle handleAt(size_t dense) const { return _handles.handleAt(dense); }
+
+			// Null for a handle whose element has been removed
+			T* get(SlotHandle handle) {
+				size_t dense = _handles.indexOf(handle);
+				return dense == HandleTable::npos ? nullptr : &_values[dense];
+			}
+
+			const T* get(SlotHandle handle) const {
+				size_t dense = _handles.indexOf(handle);
+				return dense == HandleTable::npos ? nullptr : &_values[dense];
+			}
+
+			// Dense positions shift when something is removed, only hold on to handles
+			T& operator[](size_t dense) { return _values[dense]; }
+			const T& operator[](size_t dense) const { return _values[dense]; }
+			T& back() { return _values.back(); }
+			const T& back() const { return _values.back(); }
+
+			iterator begin() { return _values.begin(); }
+			iterator end() { return _values.end(); }
+			const_iterator begin() const { return _values.begin(); }
+			const_iterator end() const { return _values.end(); }
+	};
+}
\ No newline at end of file
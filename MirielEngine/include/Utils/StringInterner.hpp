@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <shared_mutex>
+#include <cstdint>
+
+namespace MirielEngine::Utils {
+	// Stays the same for as long as the program runs, so it can be stored and compared instead of the string
+	using StringID = uint32_t;
+
+	/*
+		Hands out one ID per distinct string (shader paths, asset paths, ...). Strings are never removed, so both the IDs
+		and the references get gives back stay valid forever. Looking up a string that is already in costs a hash and a
+		shared lock but no allocation, and anything holding IDs compares and hashes plain integers from then on.
+	*/
+	class StringInterner {
+		private:
+			static StringInterner* instance;
+			static std::mutex mtx;
+
+			// deque so adding strings never moves the ones the views in ids point at
+			std::deque<std::string> strings;
+			std::unordered_map<std::string_view, StringID> ids;
+			mutable std::shared_mutex stringsMtx;
+
+			StringInterner();
+			StringInterner(const StringInterner& obj) = delete;
+		public:
+			// "" is always interned first
+			static constexpr StringID Empty = 0;
+
+			~StringInterner();
+
+			static StringInterner* getInstance();
+
+			StringID intern(std::string_view string);
+			const std::string& get(StringID id) const;
+			size_t size() const;
+	};
+
+	inline StringInterner* const GlobalStringInterner = StringInterner::getInstance();
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Utils/JobSystem.hpp"
+#include "Utils/MirielEngineLogger.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace MirielEngine::Utils {
+	/*
+		Fire and forget coroutine for asset work that hops between threads. Nothing runs until start is called, after
+		that the coroutine owns itself and frees its frame when it finishes, so the Task object can be dropped straight
+		away. Pass a JobCounter to start to be able to wait on (or chain off) the whole coroutine like any other job.
+
+			Task loadThing(std::string path) {
+				co_await switchToWorkerPool();
+				// read and decode here
+				co_await switchToMainThread();
+				// GL calls and scene edits here
+			}
+			loadThing(path).start(&counter);
+
+		Anything captured by reference (including this) has to outlive the coroutine, keep a counter and wait on it.
+	*/
+	class Task {
+		public:
+			struct promise_type {
+				JobCounter* counter = nullptr;
+
+				Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+				std::suspend_always initial_suspend() noexcept { return {}; }
+
+				// The frame is gone by the time the counter is released, whoever waits on it can tear everything down
+				struct FinalAwaiter {
+					bool await_ready() noexcept { return false; }
+					void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+						JobCounter* counter = handle.promise().counter;
+						handle.destroy();
+						if (counter) { GlobalJobSystem->releaseCounter(*counter); }
+					}
+					void await_resume() noexcept {}
+				};
+				FinalAwaiter final_suspend() noexcept { return {}; }
+
+				void return_void() {}
+				void unhandled_exception() {
+					try {
+						std::rethrow_exception(std::current_exception());
+					} catch (std::exception& e) {
+						MIRIEL_LOG(Error, Core, "Task Threw an Exception: {}", e.what());
+					} catch (...) {
+						MIRIEL_LOG(Error, Core, "Task Threw an Unknown Exception.");
+					}
+				}
+			};
+
+			Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+			Task(const Task&) = delete;
+			Task& operator=(const Task&) = delete;
+			Task& operator=(Task&&) = delete;
+			~Task() {
+				// Never started, nobody else is going to free the frame
+				if (handle) { handle.destroy(); }
+			}
+
+			// Runs the coroutine on the calling thread up to its first switch
+			void start(JobCounter* counter = nullptr) {
+				if (!handle) { return; }
+				if (counter) {
+					GlobalJobSystem->retainCounter(*counter);
+					handle.promise().counter = counter;
+				}
+				std::exchange(handle, nullptr).resume();
+			}
+		private:
+			std::coroutine_handle<promise_type> handle;
+
+			explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+	};
+
+	// Resumes the coroutine as a job on one of the workers, or on the main thread if it is helping out inside JobSystem::wait
+	struct WorkerPoolAwaiter {
+		bool await_ready() const noexcept { return false; }
+		void await_suspend(std::coroutine_handle<> handle) const {
+			GlobalJobSystem->submit([handle]() { handle.resume(); });
+		}
+		void await_resume() const noexcept {}
+	};
+
+	// Resumes the coroutine from pumpMainThread, carries straight on if it is already there
+	struct MainThreadAwaiter {
+		bool await_ready() const noexcept { return GlobalJobSystem->isMainThread(); }
+		void await_suspend(std::coroutine_handle<> handle) const {
+			GlobalJobSystem->runOnMainThread([handle]() { handle.resume(); });
+		}
+		void await_resume() const noexcept {}
+	};
+
+	inline WorkerPoolAwaiter switchToWorkerPool() { return {}; }
+	inline MainThreadAwaiter switchToMainThread() { return {}; }
+}
\ No newline at end of file
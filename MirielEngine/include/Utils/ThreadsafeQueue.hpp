@@ -1,47 +1,143 @@
 #pragma once
 
 #include <mutex>
-#include <queue>
+#include <condition_variable>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <iterator>
+#include <optional>
+#include <type_traits>
 
 namespace MirielEngine::Utils::DataStructures {
 	template <typename T>
 	class ThreadsafeQueue {
 		private:
-			std::queue<T> _queue;
-			std::mutex _mtx;
+			std::deque<T> _queue;
+			mutable std::mutex _mtx;
 			std::condition_variable _cv;
+			bool _closed = false;
 		public:
 			ThreadsafeQueue() = default;
 			~ThreadsafeQueue() = default;
-			ThreadsafeQueue(ThreadsafeQueue&&) noexcept = default;
-			ThreadsafeQueue(const ThreadsafeQueue&) = default;
-			ThreadsafeQueue& operator=(ThreadsafeQueue&&) noexcept = default;
-			ThreadsafeQueue& operator=(const ThreadsafeQueue&) = default;
+			// Holds a mutex and a condition variable, copying or moving one while other threads use it can't be made safe
+			ThreadsafeQueue(ThreadsafeQueue&&) = delete;
+			ThreadsafeQueue(const ThreadsafeQueue&) = delete;
+			ThreadsafeQueue& operator=(ThreadsafeQueue&&) = delete;
+			ThreadsafeQueue& operator=(const ThreadsafeQueue&) = delete;
 
-			void push(T&& item) {
-				std::unique_lock<std::mutex> lock(_mtx);
-				_queue.push(std::move(item));
+			// Returns false (and drops the item) once the queue has been closed
+			bool push(T&& item) {
+				{
+					std::unique_lock<std::mutex> lock(_mtx);
+					if (_closed) { return false; }
+					_queue.push_back(std::move(item));
+				}
 				_cv.notify_one();
+				return true;
+			}
+
+			// Moves every item in under one lock, returns false if the queue was closed. Only takes rvalues, an lvalue
+			// container goes through the overload below and is copied instead of quietly emptied
+			template <typename Container> requires (!std::is_lvalue_reference_v<Container>)
+			bool push_bulk(Container&& items) {
+				{
+					std::unique_lock<std::mutex> lock(_mtx);
+					if (_closed) { return false; }
+					_queue.insert(_queue.end(), std::make_move_iterator(std::begin(items)), std::make_move_iterator(std::end(items)));
+				}
+				_cv.notify_all();
+				return true;
 			}
 
-			T front() {
+			template <typename Container>
+			bool push_bulk(const Container& items) {
+				{
+					std::unique_lock<std::mutex> lock(_mtx);
+					if (_closed) { return false; }
+					_queue.insert(_queue.end(), std::begin(items), std::end(items));
+				}
+				_cv.notify_all();
+				return true;
+			}
+
+			// Blocks until there is an item and moves it out without popping it, empty once the queue is closed and drained
+			std::optional<T> front() {
 				std::unique_lock<std::mutex> lock(_mtx);
-				_cv.wait(lock, [this]{ return !_queue.empty(); });
+				_cv.wait(lock, [this] { return !_queue.empty() || _closed; });
+				if (_queue.empty()) { return std::nullopt; }
 				return std::move(_queue.front());
 			}
 
-			void pop() {
+			// Blocks until there is an item to pop, returns false once the queue is closed and drained
+			bool pop() {
+				std::unique_lock<std::mutex> lock(_mtx);
+				_cv.wait(lock, [this] { return !_queue.empty() || _closed; });
+				if (_queue.empty()) { return false; }
+				_queue.pop_front();
+				return true;
+			}
+
+			bool try_pop(T& out) {
+				std::unique_lock<std::mutex> lock(_mtx);
+				if (_queue.empty()) { return false; }
+				out = std::move(_queue.front());
+				_queue.pop_front();
+				return true;
+			}
+
+			// Waits up to timeout for an item, returns false on timeout or when the queue is closed and empty
+			template <typename Rep, typename Period>
+			bool pop_for(T& out, const std::chrono::duration<Rep, Period>& timeout) {
+				std::unique_lock<std::mutex> lock(_mtx);
+				if (!_cv.wait_for(lock, timeout, [this] { return !_queue.empty() || _closed; })) { return false; }
+				if (_queue.empty()) { return false; }
+				out = std::move(_queue.front());
+				_queue.pop_front();
+				return true;
+			}
+
+			// Appends everything currently queued to out under a single lock, returns how many were moved
+			size_t drain_into(std::vector<T>& out) {
+				std::unique_lock<std::mutex> lock(_mtx);
+				size_t count = _queue.size();
+				out.reserve(out.size() + count);
+				std::move(_queue.begin(), _queue.end(), std::back_inserter(out));
+				_queue.clear();
+				return count;
+			}
+
+			// Blocks until something arrives or the queue is closed, then drains like drain_into
+			size_t wait_drain_into(std::vector<T>& out) {
+				std::unique_lock<std::mutex> lock(_mtx);
+				_cv.wait(lock, [this] { return !_queue.empty() || _closed; });
+				size_t count = _queue.size();
+				out.reserve(out.size() + count);
+				std::move(_queue.begin(), _queue.end(), std::back_inserter(out));
+				_queue.clear();
+				return count;
+			}
+
+			// Stops further pushes and wakes every waiter, items already queued can still be popped
+			void close() {
+				{
+					std::unique_lock<std::mutex> lock(_mtx);
+					_closed = true;
+				}
+				_cv.notify_all();
+			}
+
+			bool closed() const {
 				std::unique_lock<std::mutex> lock(_mtx);
-				_cv.wait(lock, [this] { return !_queue.empty(); });
-				_queue.pop();
+				return _closed;
 			}
 
-			size_t size() {
+			size_t size() const {
 				std::unique_lock<std::mutex> lock(_mtx);
 				return _queue.size();
 			}
 
-			bool empty() {
+			bool empty() const {
 				std::unique_lock<std::mutex> lock(_mtx);
 				return _queue.empty();
 			}
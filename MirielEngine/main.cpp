@@ -2,26 +2,59 @@
 
 #include <stb_image.h>
 #include <nfd.h>
+#include <filesystem>
 //#define STB_IMAGE_WRITE_IMPLEMENTATION <- might need this is I choose to perform image compression or use GPU to create noise textures
 #include "Utils/mainUtils.hpp"
 #include "Utils/MirielEngineCore.hpp"
 #include "Utils/MirielEngineLogger.hpp"
+#include "Utils/LogCompressor.hpp"
+#include "Utils/JobSystem.hpp"
+#include "Utils/StringInterner.hpp"
 
 MirielEngine::Utils::Logger* MirielEngine::Utils::Logger::instance = nullptr;
 std::mutex MirielEngine::Utils::Logger::mtx;
+MirielEngine::Utils::JobSystem* MirielEngine::Utils::JobSystem::instance = nullptr;
+std::mutex MirielEngine::Utils::JobSystem::mtx;
+MirielEngine::Utils::StringInterner* MirielEngine::Utils::StringInterner::instance = nullptr;
+std::mutex MirielEngine::Utils::StringInterner::mtx;
 
 int main(int argc, char* argv[]) {
 	checkLoggingDir();
-	MirielEngine::Utils::GlobalLogger->log("Checking main.cpp Arguments.");
+	MIRIEL_LOG(Info, Core, "Checking main.cpp Arguments.");
 
 	if (argc < 2) {
-		MirielEngine::Utils::GlobalLogger->log("Not Enough Arguments: Expected at Least 2 Additional Arguments.");
+		MIRIEL_LOG(Error, Core, "Not Enough Arguments: Expected at Least 2 Additional Arguments.");
 		MirielEngine::Utils::GlobalLogger->cleanup();
 		throw MirielEngine::Errors::MainFunctionError("Not Enough Arguments: Expected at Least 2 Additional Arguments.");
 	}
 
+	if (std::string(argv[1]) == std::string("-d") && argc > 2) {
+		// Decode a binary log written with MIRIEL_BINARY_LOGGING back into the text format, next to the original
+		std::filesystem::path inputName(argv[2]);
+
+		// Rotated segments are compressed first, "x.log.mlz" unpacks to "x.log" and "x.mlog.mlz" to "x.mlog" which then gets decoded
+		if (inputName.extension() == MirielEngine::Utils::compressedLogExtension) {
+			std::filesystem::path unpackedName = std::filesystem::path(inputName).replace_extension("");
+			MIRIEL_LOG(Info, Core, "Decompressing Log Segment {} Into {}.", inputName.string(), unpackedName.string());
+			if (!MirielEngine::Utils::decompressLogFile(inputName.string(), unpackedName.string())) {
+				MIRIEL_LOG(Error, Core, "{} is Not a Compressed Log File or is Damaged.", inputName.string());
+			}
+			inputName = unpackedName;
+		}
+
+		if (inputName.extension() == ".mlog") {
+			std::string outputName = std::filesystem::path(inputName).replace_extension(".log").string();
+			MIRIEL_LOG(Info, Core, "Decoding Binary Log {} Into {}.", inputName.string(), outputName);
+			if (!MirielEngine::Utils::decodeBinaryLog(inputName.string(), outputName)) {
+				MIRIEL_LOG(Error, Core, "{} is Not a Binary Log File.", inputName.string());
+			}
+		}
+		MirielEngine::Utils::GlobalLogger->cleanup();
+		return 0;
+	}
+
 	if (std::string(argv[1]) != std::string("-e")) {
-		MirielEngine::Utils::GlobalLogger->log("Incorrect Arguments: argv[1] Should be '-e'.");
+		MIRIEL_LOG(Error, Core, "Incorrect Arguments: argv[1] Should be '-e'.");
 		MirielEngine::Utils::GlobalLogger->cleanup();
 		throw MirielEngine::Errors::MainFunctionError("Incorrect Arguments: argv[1] Should be '-e'.");
 	}
@@ -30,18 +63,18 @@ int main(int argc, char* argv[]) {
 
 	if (std::string(argv[2]) == std::string("DX12")) {
 		backend = RENDER_BACKEND::DX12;
-		MirielEngine::Utils::GlobalLogger->log("Using DirectX12 Backend.");
+		MIRIEL_LOG(Info, Core, "Using DirectX12 Backend.");
 	} else if (std::string(argv[2]) == std::string("OpenGL")) {
 		backend = RENDER_BACKEND::OPENGL;
-		MirielEngine::Utils::GlobalLogger->log("Using OpenGL Backend.");
+		MIRIEL_LOG(Info, Core, "Using OpenGL Backend.");
 	} else if (std::string(argv[2]) == std::string("Vulkan")) {
 		backend = RENDER_BACKEND::VULKAN;
-		MirielEngine::Utils::GlobalLogger->log("Using Vulkan Backend.");
+		MIRIEL_LOG(Info, Core, "Using Vulkan Backend.");
 	} else if (std::string(argv[2]) == std::string("Metal")) {
 		backend = RENDER_BACKEND::METAL;
-		MirielEngine::Utils::GlobalLogger->log("Using Metal Backend.");
+		MIRIEL_LOG(Info, Core, "Using Metal Backend.");
 	} else {
-		MirielEngine::Utils::GlobalLogger->log("Expected One of the Following After '-e': 'DX12', 'OpenGL', 'Vulkan', or 'Metal'.");
+		MIRIEL_LOG(Error, Core, "Expected One of the Following After '-e': 'DX12', 'OpenGL', 'Vulkan', or 'Metal'.");
 		MirielEngine::Utils::GlobalLogger->cleanup();
 		throw MirielEngine::Errors::MainFunctionError("Expected One of the Following After '-e': 'DX12', 'OpenGL', 'Vulkan', or 'Metal'.");
 	}
@@ -52,12 +85,16 @@ int main(int argc, char* argv[]) {
 		MirielEngine::Core::StartBackend(backend);
 	} catch (MirielEngine::Errors::CoreError& e) {
 		MirielEngine::Utils::GlobalLogger->log(e.what());
-		MirielEngine::Utils::GlobalLogger->log("Program Finished Running: Cleaning Up Logger.");
+		MIRIEL_LOG(Info, Core, "Program Finished Running: Cleaning Up Job System.");
+		MirielEngine::Utils::GlobalJobSystem->cleanup();
+		MIRIEL_LOG(Info, Core, "Program Finished Running: Cleaning Up Logger.");
 		MirielEngine::Utils::GlobalLogger->cleanup();
 		NFD_Quit();
 	}
 
-	MirielEngine::Utils::GlobalLogger->log("Program Finished Running: Cleaning Up Logger.");
+	MIRIEL_LOG(Info, Core, "Program Finished Running: Cleaning Up Job System.");
+	MirielEngine::Utils::GlobalJobSystem->cleanup();
+	MIRIEL_LOG(Info, Core, "Program Finished Running: Cleaning Up Logger.");
 	MirielEngine::Utils::GlobalLogger->cleanup();
 	NFD_Quit();
 }
\ No newline at end of file
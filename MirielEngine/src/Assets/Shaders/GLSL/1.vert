@@ -13,12 +13,34 @@ out vec3 oNorm;
 out vec3 oColor;
 out vec2 oTexCoord;
 
-uniform mat4 model;
+// Every instance's world matrix for the object being drawn
+layout (std430, binding = 0) readonly buffer Transforms {
+	mat4 models[];
+};
+
+// One matrix per mesh of the model, its node's world matrix, node picks the current mesh's
+layout (std430, binding = 1) readonly buffer Nodes {
+	mat4 nodes[];
+};
+
+// Per mesh as well, compact vertices store positions 0 to 1 across the mesh's bounds, full ones get scale 1 and offset 0
+struct PositionDequantize {
+	vec4 offset;
+	vec4 scale;
+};
+
+layout (std430, binding = 2) readonly buffer Dequantize {
+	PositionDequantize dequantize[];
+};
+
+uniform uint node;
 
 void main() {
+	vec3 position = aPos * dequantize[node].scale.xyz + dequantize[node].offset.xyz;
+	mat4 model = models[gl_BaseInstance + gl_InstanceID] * nodes[node];
 	mat4 mvp = projection * view * model;
 	oNorm = vec3((mvp * vec4(aNorm,1.0)).xyz);
 	oColor = aColor;
 	oTexCoord = aTexCoord;
-	gl_Position = mvp * vec4(aPos, 1.0);
+	gl_Position = mvp * vec4(position, 1.0);
 }
\ No newline at end of file
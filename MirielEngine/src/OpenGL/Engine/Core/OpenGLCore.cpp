@@ -1,5 +1,9 @@
-#include <iostream>
 #include <filesystem>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <future>
+#include <thread>
 
 #include <stb_image.h>
 #include <glm/gtc/type_ptr.hpp>
@@ -11,18 +15,95 @@
 #include "OpenGL/Engine/Utils/OpenGLUtils.hpp"
 
 namespace MirielEngine::OpenGL {
+	namespace {
+		// Same swap the scene's slot map does, so GL arrays keep lining up with scene->objects
+		template <typename T>
+		void removeAt(std::vector<T>& values, size_t i) {
+			if (i != values.size() - 1) { values[i] = std::move(values.back()); }
+			values.pop_back();
+		}
+
+		/*
+			Decodes are plain worker jobs. JobSystem::wait on the main thread would pump main thread jobs as well, and a
+			finished import run from in there adds to scene->objects under whoever is holding an index into it.
+		*/
+		void waitForDecodes(const MirielEngine::Utils::JobCounter& decodes) {
+			while (!decodes.done()) {
+				std::this_thread::yield();
+			}
+		}
+
+		// Vertex data and attribute formats for whichever layout the object is in, expects its VAO and VBO bound
+		void uploadVertices(const MirielEngine::Core::Object& object) {
+			using MirielEngine::Core::Vertex;
+			using MirielEngine::Core::CompactVertex;
+
+			if (object.vertexLayout == MirielEngine::Core::VertexLayout::Compact) {
+				glBufferData(GL_ARRAY_BUFFER, object.compactVertices.size() * sizeof(CompactVertex), object.compactVertices.data(), GL_STATIC_DRAW);
+
+				// Positions come out 0 to 1 across the mesh, the vertex shader puts them back with uploadDequantize's buffer
+				glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(CompactVertex), (void*)(offsetof(CompactVertex, position)));
+				glEnableVertexAttribArray(0);
+				glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(CompactVertex), (void*)(offsetof(CompactVertex, normal)));
+				glEnableVertexAttribArray(1);
+				// Colour is set with glVertexAttrib3f when the object is drawn
+				glDisableVertexAttribArray(2);
+				glVertexAttribPointer(3, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(CompactVertex), (void*)(offsetof(CompactVertex, texCoord)));
+				glEnableVertexAttribArray(3);
+				return;
+			}
+
+			glBufferData(GL_ARRAY_BUFFER, object.vertices.size() * sizeof(Vertex), object.vertices.data(), GL_STATIC_DRAW);
+
+			// location in shader, size of vertex, type, if normalized, space between vertex objects, offset of position data in vertex
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, normal)));
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, color)));
+			glEnableVertexAttribArray(2);
+			glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(offsetof(Vertex, texCoord)));
+			glEnableVertexAttribArray(3);
+		}
+
+		// One entry per mesh range, the vertex shader reads it at the same index as the node matrix
+		void uploadDequantize(const MirielEngine::Core::Object& object) {
+			std::vector<MirielEngine::Core::PositionDequantize> dequantize;
+			dequantize.reserve(object.meshes.size());
+			for (const MirielEngine::Core::MeshRange& mesh : object.meshes) {
+				dequantize.push_back(object.getPositionDequantize(mesh));
+			}
+			glBufferData(GL_SHADER_STORAGE_BUFFER, dequantize.size() * sizeof(MirielEngine::Core::PositionDequantize), dequantize.data(), GL_STATIC_DRAW);
+		}
+
+		// Expects the object's VAO bound, the element buffer binding is part of it
+		void uploadIndices(const MirielEngine::Core::Object& object) {
+			if (object.indexType == MirielEngine::Core::IndexType::UInt16) {
+				glBufferData(GL_ELEMENT_ARRAY_BUFFER, object.shortIndices.size() * sizeof(uint16_t), object.shortIndices.data(), GL_STATIC_DRAW);
+				return;
+			}
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, object.indices.size() * sizeof(unsigned int), object.indices.data(), GL_STATIC_DRAW);
+		}
+	}
+
 	OpenGLCore::OpenGLCore() {
 		// load in objects here
 		// load in buffers
-		MirielEngine::Utils::GlobalLogger->log("Creating OpenGL Core.");
+		MIRIEL_LOG(Info, OpenGL, "Creating OpenGL Core.");
 		currentProgram = 0;
+		textureUploadPBO = 0;
+		resourceGeneration = 0;
+		preparedGeneration = 0;
+		texturesStreamed = 0;
+		glThreadID = std::this_thread::get_id();
 		scene = std::make_shared<MirielEngine::Core::Scene>();
 		scene->textureLoader = ([this](const std::string& s) {return loadTexture(s); });
 		scene->clearAPIFunction = ([this]() { return cleanUp(); });
+		scene->removeObjectFunction = ([this](size_t index) { removeObject(index); });
 		try {
 			scene->newScene();
 		} catch (MirielEngine::Errors::ObjectLoaderError& e) {
-			MirielEngine::Utils::GlobalLogger->log(e.what());
+			MIRIEL_LOG(Error, Loader, "{}", e.what());
 		}
 
 		createBuffers();
@@ -35,70 +116,300 @@ namespace MirielEngine::OpenGL {
 	}
 
 	void OpenGLCore::cleanUp() {
-		for (GLuint program : programs) {
-			glDeleteProgram(program);
-		}
+		// Comes from the editor on the main thread when New Scene is picked, the objects it deletes live on the GL thread
+		invokeGL([this]() {
+			for (GLuint program : programs) {
+				glDeleteProgram(program);
+			}
 
-		glDeleteBuffers(objectVBOs.size(), objectVBOs.data());
-		glDeleteBuffers(objectEBOs.size(), objectEBOs.data());
-		glDeleteVertexArrays(objectVAOs.size(), objectVAOs.data());
+			glDeleteBuffers(objectVBOs.size(), objectVBOs.data());
+			glDeleteBuffers(objectEBOs.size(), objectEBOs.data());
+			glDeleteVertexArrays(objectVAOs.size(), objectVAOs.data());
+			glDeleteBuffers(transformSSBOs.size(), transformSSBOs.data());
+			glDeleteBuffers(nodeSSBOs.size(), nodeSSBOs.data());
+			glDeleteBuffers(dequantizeSSBOs.size(), dequantizeSSBOs.data());
+
+			for (auto object : scene->objects) {
+				for (auto texture : object.textures) {
+					glDeleteTextures(1, &texture.ID);
+				}
+			}
+
+			// Anything still decoding belongs to a texture that was just deleted, it gets dropped when it turns up
+			resourceGeneration++;
+			pendingUploads.clear();
+			std::vector<DecodedTexture> staleTextures;
+			decodedTextures.drain_into(staleTextures);
+
+			objectEBOs.clear();
+			objectVAOs.clear();
+			objectVBOs.clear();
+			transformSSBOs.clear();
+			transformCapacities.clear();
+			nodeSSBOs.clear();
+			dequantizeSSBOs.clear();
+			objectMeshes.clear();
+			objectVertexColors.clear();
+			objectIndexTypes.clear();
+			UBOIDs.clear();
+			programs.clear();
+			nodeLocations.clear();
+		});
+	}
 
-		for (auto object : scene->objects) {
-			for (auto texture : object.textures) {
+	void OpenGLCore::removeObject(size_t index) {
+		invokeGL([this, index]() {
+			// The object's textures could still be decoding, once the names are deleted a new texture can get one and the old pixels with it
+			waitForDecodes(textureDecodes);
+			std::vector<DecodedTexture> decoded;
+			decodedTextures.drain_into(decoded);
+			for (DecodedTexture& texture : decoded) {
+				if (texture.generation == resourceGeneration) { pendingUploads.push_back(std::move(texture)); }
+			}
+
+			// Anything the scene added but isn't uploaded yet could be the one swapped into index
+			updateBuffers();
+			size_t objectCount = objectVBOs.size();
+			if (index >= objectCount) { return; }
+
+			const std::pmr::vector<MirielEngine::Core::Texture>& objectTextures = scene->objects[index].textures;
+			std::erase_if(pendingUploads, [&objectTextures](const DecodedTexture& texture) {
+				return std::any_of(objectTextures.begin(), objectTextures.end(), [&texture](const MirielEngine::Core::Texture& t) { return t.ID == texture.ID; });
+			});
+			for (const MirielEngine::Core::Texture& texture : objectTextures) {
 				glDeleteTextures(1, &texture.ID);
 			}
-		}
 
-		objectEBOs.clear();
-		objectVAOs.clear();
-		objectVBOs.clear();
-		UBOIDs.clear();
-		programs.clear();
+			// Transform buffers are only made once something is uploaded, so they can be shorter than the rest
+			transformSSBOs.resize(std::max(transformSSBOs.size(), objectCount), 0);
+			transformCapacities.resize(std::max(transformCapacities.size(), objectCount), 0);
+			nodeSSBOs.resize(std::max(nodeSSBOs.size(), objectCount), 0);
+			dequantizeSSBOs.resize(std::max(dequantizeSSBOs.size(), objectCount), 0);
+
+			glDeleteBuffers(1, &objectVBOs[index]);
+			glDeleteBuffers(1, &objectEBOs[index]);
+			glDeleteVertexArrays(1, &objectVAOs[index]);
+			glDeleteBuffers(1, &transformSSBOs[index]);
+			glDeleteBuffers(1, &nodeSSBOs[index]);
+			glDeleteBuffers(1, &dequantizeSSBOs[index]);
+
+			removeAt(objectVBOs, index);
+			removeAt(objectEBOs, index);
+			removeAt(objectVAOs, index);
+			removeAt(transformSSBOs, index);
+			removeAt(transformCapacities, index);
+			removeAt(nodeSSBOs, index);
+			removeAt(dequantizeSSBOs, index);
+			removeAt(objectMeshes, index);
+			removeAt(objectVertexColors, index);
+			removeAt(objectIndexTypes, index);
+
+			// Frames already built name objects by index, and the decodes still to come were all drained above
+			resourceGeneration++;
+		});
 	}
 
 	OpenGLCore::~OpenGLCore() {
-		MirielEngine::Utils::GlobalLogger->log("Destroying OpenGL Core.");
+		MIRIEL_LOG(Info, OpenGL, "Destroying OpenGL Core.");
+		// Imports still running call back into loadTexture, then decode jobs push into decodedTextures, both have to be finished first
+		scene->waitForImports();
+		MirielEngine::Utils::GlobalJobSystem->wait(textureDecodes);
 		cleanUp();
 		glDeleteBuffers(UBOs.size(), UBOs.data());
 		UBOs.clear();
+		if (textureUploadPBO != 0) { glDeleteBuffers(1, &textureUploadPBO); }
 	}
 
-	void OpenGLCore::draw(int width, int height) {
-		updateBuffers();
-		updateProgram();
+	void OpenGLCore::syncResources() {
+		// Nearly every frame has nothing new, that shouldn't cost a round trip to the render thread
+		if (scene->objects.size() == objectVBOs.size() && scene->shaderCombinations.size() == programs.size()) { return; }
+
+		invokeGL([this]() {
+			updateBuffers();
+			updateProgram();
+		});
+	}
+
+	void OpenGLCore::prepareFrame(int width, int height) {
+		std::vector<DrawItem>& drawList = preparedFrame.drawList;
+		std::vector<TransformRange>& transformRanges = preparedFrame.transformRanges;
+		std::vector<glm::mat4>& transformUploads = preparedFrame.transformUploads;
+		drawList.clear();
+		transformRanges.clear();
+		transformUploads.clear();
 
+		preparedFrame.generation = resourceGeneration;
+		preparedFrame.view = glm::lookAt(scene->camera.pos, scene->camera.target, scene->camera.camUp);
+		preparedFrame.projection = glm::perspective(glm::radians(45.0f), (float)width/(float)height, 0.1f, 1000.0f);
+
+		// Anything changed stays queued in the stores until there is something to draw it with
 		if (programs.empty() || objectVAOs.empty() || objectEBOs.empty() || objectVBOs.empty() || UBOs.empty()) { return; }
 
-		glm::mat4 view = glm::lookAt(scene->camera.pos, scene->camera.target, scene->camera.camUp);
-		glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width/(float)height, 0.1f, 1000.0f);
+		if (preparedGeneration != preparedFrame.generation) {
+			scene->markAllTransformsDirty();
+			preparedGeneration = preparedFrame.generation;
+		}
+		scene->updateTransforms();
+
+		size_t objectCount = std::min(scene->objectInstances.size(), objectVAOs.size());
+		for (size_t objectIndex = 0; objectIndex < objectCount; objectIndex++) {
+			MirielEngine::Core::InstanceStore& instances = scene->objectInstances[objectIndex];
+			MirielEngine::Core::Object& sceneObject = scene->objects[objectIndex];
+			uint32_t object = static_cast<uint32_t>(objectIndex);
+
+			if (!instances.moved.empty()) {
+				// Close together instances go up as one range, a few unchanged matrices along for the ride beats another glBufferSubData
+				std::pmr::vector<uint32_t>& moved = instances.moved;
+				std::sort(moved.begin(), moved.end());
+				for (size_t i = 0; i < moved.size();) {
+					size_t last = i;
+					while (last + 1 < moved.size() && moved[last + 1] - moved[last] <= 16) { last++; }
+
+					uint32_t first = moved[i];
+					uint32_t count = moved[last] - first + 1;
+					transformRanges.push_back(TransformRange{ object, first, count, transformUploads.size(), TransformBuffer::Instances });
+					transformUploads.insert(transformUploads.end(), instances.worldMatrices.begin() + first, instances.worldMatrices.begin() + first + count);
+					i = last + 1;
+				}
+				moved.clear();
+			}
+
+			// One matrix per mesh range, its node's world matrix. Models rarely have more than a few hundred, they all go up
+			// whenever any node moves
+			if (sceneObject.nodesMoved && !sceneObject.meshes.empty()) {
+				uint32_t count = static_cast<uint32_t>(sceneObject.meshes.size());
+				transformRanges.push_back(TransformRange{ object, 0, count, transformUploads.size(), TransformBuffer::Nodes });
+				for (const MirielEngine::Core::MeshRange& mesh : sceneObject.meshes) {
+					transformUploads.push_back(sceneObject.nodes.worlds[mesh.node]);
+				}
+			}
+			sceneObject.nodesMoved = false;
+
+			GLuint VAO = objectVAOs[objectIndex];
+			for (size_t i = 0; i < instances.size(); i++) {
+				uint32_t combination = instances.shaderCombinations[i];
+				GLuint program = combination < programs.size() ? programs[combination] : 0;
+				GLint nodeLocation = combination < nodeLocations.size() ? nodeLocations[combination] : -1;
+
+				// Instances mostly share a program, so this is usually one instanced draw per mesh
+				if (!drawList.empty()) {
+					DrawItem& previous = drawList.back();
+					if (previous.program == program && previous.object == object && previous.firstInstance + previous.instanceCount == i) {
+						previous.instanceCount++;
+						continue;
+					}
+				}
+				drawList.push_back(DrawItem{ program, nodeLocation, VAO, object, static_cast<GLuint>(i), 1 });
+			}
+		}
+
+		std::sort(drawList.begin(), drawList.end(), [](const DrawItem& a, const DrawItem& b) {
+			return a.program != b.program ? a.program < b.program : a.VAO < b.VAO;
+		});
+	}
+
+	FrameSnapshot& OpenGLCore::getPreparedFrame() {
+		return preparedFrame;
+	}
+
+	void OpenGLCore::draw(const FrameSnapshot& frame) {
+		processTextureUploads();
+
+		// A frame the render thread picked up just before New Scene or an object removal still names objects by their old indices
+		if (frame.generation != resourceGeneration) { return; }
+
+		uploadTransforms(frame);
+		if (frame.drawList.empty()) { return; }
 
 		glBindBuffer(GL_UNIFORM_BUFFER, UBOs[0]);
-		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(projection));
-		glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(view));
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(frame.projection));
+		glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), glm::value_ptr(frame.view));
 		glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
-		for (const auto& objInstance : scene->objectInstances) {
-			glBindVertexArray(objectVAOs[objInstance.first]);
-			//glBindBuffer(GL_ARRAY_BUFFER, objectVBOs[objInstance.first]);
-			//glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, objectEBOs[objInstance.first]);
-
-			// TODO: Make uniforms
-			// TODO: Custom Shader Class, quickly add uniforms and stuff
-			// TODO: Camera and Light Structs
-			// TODO: Camera and Light in Shaders
-			// TODO: Use some Textured objects
-			// TODO: Check out UBO's to send data to shaders? Lights and the Unchanging view projections
-			// TODO: Need to add in shadow pass for objects :(
-
-			for (const auto& instance : objInstance.second) {
-				glUseProgram(instance.shaderProgram.ID);
-				glm::mat4 model = instance.mTranslation * glm::mat4_cast(instance.mRotation) * instance.mScale;
-				int modelLoc = glGetUniformLocation(programs[currentProgram], "model");
-				glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-				glDrawElements(GL_TRIANGLES, scene->objects[objInstance.first].indices.size(), GL_UNSIGNED_INT, 0);
+		// TODO: Make uniforms
+		// TODO: Custom Shader Class, quickly add uniforms and stuff
+		// TODO: Camera and Light Structs
+		// TODO: Camera and Light in Shaders
+		// TODO: Use some Textured objects
+		// TODO: Check out UBO's to send data to shaders? Lights and the Unchanging view projections
+		// TODO: Need to add in shadow pass for objects :(
+
+		GLuint boundProgram = 0;
+		GLuint boundVAO = 0;
+		for (const DrawItem& item : frame.drawList) {
+			if (item.program != boundProgram) {
+				glUseProgram(item.program);
+				boundProgram = item.program;
+			}
+			if (item.VAO != boundVAO) {
+				glBindVertexArray(item.VAO);
+				// Objects and VAOs are one to one, so the object's transforms only change with it
+				glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, transformSSBOs[item.object]);
+				glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, item.object < nodeSSBOs.size() ? nodeSSBOs[item.object] : 0);
+				glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, item.object < dequantizeSSBOs.size() ? dequantizeSSBOs[item.object] : 0);
+				// Current attribute values aren't part of the VAO, only used by objects that left colour out of their vertices
+				glVertexAttrib3fv(2, glm::value_ptr(objectVertexColors[item.object]));
+				boundVAO = item.VAO;
+			}
+
+			const std::vector<MirielEngine::Core::MeshRange>& meshes = objectMeshes[item.object];
+			GLenum indexType = objectIndexTypes[item.object];
+			size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int);
+			for (GLuint meshIndex = 0; meshIndex < meshes.size(); meshIndex++) {
+				const MirielEngine::Core::MeshRange& mesh = meshes[meshIndex];
+				glUniform1ui(item.nodeLocation, meshIndex);
+				glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, mesh.indexCount, indexType, (void*)(mesh.firstIndex * indexSize),
+															item.instanceCount, mesh.baseVertex, item.firstInstance);
 			}
-			glBindVertexArray(0);
 		}
+		glBindVertexArray(0);
+	}
+
+	void OpenGLCore::uploadTransforms(const FrameSnapshot& frame) {
+		if (frame.transformRanges.empty()) { return; }
+
+		for (const TransformRange& range : frame.transformRanges) {
+			const float* matrices = glm::value_ptr(frame.transformUploads[range.uploadOffset]);
+			if (range.buffer == TransformBuffer::Nodes) {
+				// Always the whole set of nodes, so the buffer is just specified again
+				if (nodeSSBOs.size() <= range.object) { nodeSSBOs.resize(range.object + 1, 0); }
+				if (nodeSSBOs[range.object] == 0) { glGenBuffers(1, &nodeSSBOs[range.object]); }
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, nodeSSBOs[range.object]);
+				glBufferData(GL_SHADER_STORAGE_BUFFER, range.count * sizeof(glm::mat4), matrices, GL_DYNAMIC_DRAW);
+				continue;
+			}
+
+			reserveTransformBuffer(range.object, static_cast<size_t>(range.first) + range.count);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, transformSSBOs[range.object]);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, range.first * sizeof(glm::mat4), range.count * sizeof(glm::mat4), matrices);
+		}
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	void OpenGLCore::reserveTransformBuffer(uint32_t object, size_t instanceCount) {
+		if (transformSSBOs.size() <= object) {
+			transformSSBOs.resize(object + 1, 0);
+			transformCapacities.resize(object + 1, 0);
+		}
+		if (transformCapacities[object] >= instanceCount) { return; }
+
+		// Doubles so adding instances one at a time in the editor doesn't reallocate every frame
+		size_t capacity = std::max(instanceCount, transformCapacities[object] * 2);
+		GLuint buffer;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(glm::mat4), NULL, GL_DYNAMIC_DRAW);
+
+		// Only changed matrices are ever sent, the rest have to come across from the old buffer
+		if (transformSSBOs[object] != 0) {
+			glBindBuffer(GL_COPY_READ_BUFFER, transformSSBOs[object]);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_SHADER_STORAGE_BUFFER, 0, 0, transformCapacities[object] * sizeof(glm::mat4));
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+			glDeleteBuffers(1, &transformSSBOs[object]);
+		}
+
+		transformSSBOs[object] = buffer;
+		transformCapacities[object] = capacity;
 	}
 
 	void OpenGLCore::updateBuffers() {
@@ -119,61 +430,56 @@ namespace MirielEngine::OpenGL {
 			unsigned int VAO;
 			glGenVertexArrays(1, &VAO);
 			objectVAOs.push_back(VAO);
+			objectMeshes.emplace_back(scene->objects[i].meshes.begin(), scene->objects[i].meshes.end());
+			objectVertexColors.push_back(scene->objects[i].vertexColor);
+			objectIndexTypes.push_back(scene->objects[i].indexType == MirielEngine::Core::IndexType::UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
 
 			glBindVertexArray(objectVAOs[i]);
 
 			glBindBuffer(GL_ARRAY_BUFFER, objectVBOs[i]);
-			glBufferData(GL_ARRAY_BUFFER, scene->objects[i].vertices.size() * sizeof(MirielEngine::Core::Vertex), scene->objects[i].vertices.data(), GL_STATIC_DRAW);
+			uploadVertices(scene->objects[i]);
 
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, objectEBOs[i]);
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, scene->objects[i].indices.size() * sizeof(unsigned int), scene->objects[i].indices.data(), GL_STATIC_DRAW);
-
-			// location in shader, size of vertex, type, if normalized, space between vertex objects, offset of position data in vertex
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MirielEngine::Core::Vertex), (void*)0);
-			glEnableVertexAttribArray(0);
-			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(MirielEngine::Core::Vertex), (void*)(offsetof(MirielEngine::Core::Vertex, normal)));
-			glEnableVertexAttribArray(1);
-			glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(MirielEngine::Core::Vertex), (void*)(offsetof(MirielEngine::Core::Vertex, color)));
-			glEnableVertexAttribArray(2);
-			glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(MirielEngine::Core::Vertex), (void*)(offsetof(MirielEngine::Core::Vertex, texCoord)));
-			glEnableVertexAttribArray(3);
+			uploadIndices(scene->objects[i]);
 
 			glBindVertexArray(0);
+
+			unsigned int dequantizeSSBO;
+			glGenBuffers(1, &dequantizeSSBO);
+			dequantizeSSBOs.push_back(dequantizeSSBO);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, dequantizeSSBO);
+			uploadDequantize(scene->objects[i]);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 		}
 	}
 
 	void OpenGLCore::updateProgram() {
-		size_t offset = scene->loadedShaderCombinations.size() - programs.size();
-
-		if (offset == 0) { return; }
-
-		for (auto& shaderCombination : scene->loadedShaderCombinations) {
-			if (shaderCombination.second.loaded) { continue; }
-			MirielEngine::Utils::GlobalLogger->log("Loading in a new Shader Combination.");
-			size_t splitIndex = shaderCombination.first.find(' '); // need to find space index, split into 2 strings
-
-			std::string vertShaderName;
-			std::string fragShaderName;
+		// programs lines up with scene->shaderCombinations, anything past the end of it is new
+		if (programs.size() == scene->shaderCombinations.size()) { return; }
+
+		for (size_t i = programs.size(); i < scene->shaderCombinations.size(); i++) {
+			MirielEngine::Core::ShaderCombination& shaderCombination = scene->shaderCombinations[i];
+
+			if (shaderCombination.vertexShader == MirielEngine::Utils::StringInterner::Empty || shaderCombination.fragmentShader == MirielEngine::Utils::StringInterner::Empty) {
+				// Only half picked in the editor, it gets a slot so the indices stay lined up and draws with program 0
+				programs.push_back(0);
+				nodeLocations.push_back(-1);
+				UBOIDs.push_back(GL_INVALID_INDEX);
+				continue;
+			}
 
-			vertShaderName = shaderCombination.first.substr(0, splitIndex);
-			fragShaderName = shaderCombination.first.substr(splitIndex + 1, shaderCombination.first.size() - vertShaderName.size() - 1);
+			const std::string& vertexShaderName = MirielEngine::Utils::GlobalStringInterner->get(shaderCombination.vertexShader);
+			const std::string& fragmentShaderName = MirielEngine::Utils::GlobalStringInterner->get(shaderCombination.fragmentShader);
+			MIRIEL_LOG(Debug, OpenGL, "Loading in Shader Combination: {} {}", vertexShaderName, fragmentShaderName);
 
 			try {
-				programs.push_back(MirielEngine::OpenGL::createShaderProgram(vertShaderName.c_str(), fragShaderName.c_str()));
-				shaderCombination.second = MirielEngine::Core::Shader{ programs.back(), true};
+				programs.push_back(MirielEngine::OpenGL::createShaderProgram(vertexShaderName.c_str(), fragmentShaderName.c_str()));
+				shaderCombination.shader = MirielEngine::Core::Shader{ programs.back(), 0, true };
 			} catch (const MirielEngine::Errors::OpenGLUtilError& e) {
 				throw MirielEngine::Errors::OpenGLError(e.what());
 			}
-		}
-
-		for (auto& object : scene->objectInstances) {
-			for (auto& objectInstance : object.second) {
-				std::string key = objectInstance.vertexShaderName + " " + objectInstance.fragmentShaderName;
-				objectInstance.shaderProgram = scene->loadedShaderCombinations[key];
-			}
-		}
 
-		for (size_t i = scene->loadedShaderCombinations.size() - offset; i < scene->loadedShaderCombinations.size(); i++) {
+			nodeLocations.push_back(glGetUniformLocation(programs[i], "node"));
 			UBOIDs.push_back(glGetUniformBlockIndex(programs[i], "Matrices"));
 			glUniformBlockBinding(programs[i], UBOIDs[i], 0);
 		}
@@ -189,26 +495,32 @@ namespace MirielEngine::OpenGL {
 		objectVAOs.resize(scene->objects.size());
 		glGenVertexArrays(scene->objects.size(), objectVAOs.data());
 
-		for (const auto& objInstance : scene->objectInstances) {
-			glBindVertexArray(objectVAOs[objInstance.first]);
-			// contains ObjectInstances, can get transforms from indices it
-			glBindBuffer(GL_ARRAY_BUFFER, objectVBOs[objInstance.first]);
-			glBufferData(GL_ARRAY_BUFFER, scene->objects[objInstance.first].vertices.size() * sizeof(MirielEngine::Core::Vertex), scene->objects[objInstance.first].vertices.data(), GL_STATIC_DRAW);
+		dequantizeSSBOs.resize(scene->objects.size());
+		glGenBuffers(scene->objects.size(), dequantizeSSBOs.data());
 
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, objectEBOs[objInstance.first]);
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, scene->objects[objInstance.first].indices.size() * sizeof(unsigned int), scene->objects[objInstance.first].indices.data(), GL_STATIC_DRAW);
+		objectMeshes.clear();
+		objectVertexColors.clear();
+		objectIndexTypes.clear();
+		for (const MirielEngine::Core::Object& object : scene->objects) {
+			objectMeshes.emplace_back(object.meshes.begin(), object.meshes.end());
+			objectVertexColors.push_back(object.vertexColor);
+			objectIndexTypes.push_back(object.indexType == MirielEngine::Core::IndexType::UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
+		}
 
-			// location in shader, size of vertex, type, if normalized, space between vertex objects, offset of position data in vertex
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MirielEngine::Core::Vertex), (void*)0);
-			glEnableVertexAttribArray(0);
-			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(MirielEngine::Core::Vertex), (void*)(offsetof(MirielEngine::Core::Vertex, normal)));
-			glEnableVertexAttribArray(1);
-			glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(MirielEngine::Core::Vertex), (void*)(offsetof(MirielEngine::Core::Vertex, color)));
-			glEnableVertexAttribArray(2);
-			glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(MirielEngine::Core::Vertex), (void*)(offsetof(MirielEngine::Core::Vertex, texCoord)));
-			glEnableVertexAttribArray(3);
+		for (size_t i = 0; i < scene->objects.size(); i++) {
+			glBindVertexArray(objectVAOs[i]);
+			// contains ObjectInstances, can get transforms from indices it
+			glBindBuffer(GL_ARRAY_BUFFER, objectVBOs[i]);
+			uploadVertices(scene->objects[i]);
+
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, objectEBOs[i]);
+			uploadIndices(scene->objects[i]);
 
 			glBindVertexArray(0);
+
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, dequantizeSSBOs[i]);
+			uploadDequantize(scene->objects[i]);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 		}
 
 		// Create UBOs for each program
@@ -242,45 +554,161 @@ namespace MirielEngine::OpenGL {
 		currentProgram--;
 	}
 
+	void DecodedImageDeleter::operator()(unsigned char* pixels) const {
+		stbi_image_free(pixels);
+	}
+
 	unsigned int OpenGLCore::loadTexture(const std::string& textureName) {
-		std::cout << "Load Texture Called!" << std::endl;
-		std::string location = std::filesystem::current_path().string() + "/src/Assets/Models/" + textureName;
+		MIRIEL_LOG(Trace, OpenGL, "Loading in Texture: {}", textureName);
 
 		unsigned int texID;
-		glGenTextures(1, &texID);
+		uint64_t generation;
+		invokeGL([this, &texID, &generation]() {
+			glGenTextures(1, &texID);
+
+			// 1x1 white stands in until the real image has been decoded and uploaded over it, the ID stays the same
+			const unsigned char placeholder[4] = { 255, 255, 255, 255 };
+			glBindTexture(GL_TEXTURE_2D, texID);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glBindTexture(GL_TEXTURE_2D, 0);
+
+			// Read here because cleanUp bumps it on the GL thread
+			generation = resourceGeneration;
+		});
+		MirielEngine::Utils::GlobalJobSystem->submit([this, textureName, texID, generation]() {
+			DecodedTexture texture{};
+			texture.ID = texID;
+			texture.generation = generation;
+			texture.name = textureName;
+
+			stbi_uc* pixels = stbi_load(textureName.c_str(), &texture.width, &texture.height, &texture.channels, 0);
+			if (!pixels) {
+				// Nobody is left to catch a throw out here, the placeholder just stays in place
+				std::string location = std::filesystem::current_path().string() + "/src/Assets/Models/" + textureName;
+				MIRIEL_LOG(Error, OpenGL, "Failed to Load Texture Located at: {}.", location);
+				return;
+			}
+			texture.pixels.reset(pixels);
+			decodedTextures.push(std::move(texture));
+		}, &textureDecodes);
 
-		int texWidth, texHeight, texChannels;
-		stbi_uc* pixels = stbi_load(textureName.c_str(), &texWidth, &texHeight, &texChannels, 0);
+		return texID;
+	}
 
-		if (!pixels) {
-			stbi_image_free(pixels);
-			std::ostringstream os;
-			os << "Failed to Load Texture Located at: " << location << ".";
-			MirielEngine::Utils::GlobalLogger->log(os.str());
-			throw MirielEngine::Errors::OpenGLError(os.str().c_str());
+	void OpenGLCore::processTextureUploads() {
+		DecodedTexture decoded;
+		while (decodedTextures.try_pop(decoded)) {
+			if (decoded.generation == resourceGeneration) {
+				pendingUploads.push_back(std::move(decoded));
+			}
 		}
 
-		GLenum format;
-		if (texChannels == 1) {
+		if (pendingUploads.empty()) { return; }
+		if (textureUploadPBO == 0) { glGenBuffers(1, &textureUploadPBO); }
+
+		auto start = std::chrono::steady_clock::now();
+		size_t uploadedBytes = 0;
+		while (!pendingUploads.empty()) {
+			const DecodedTexture& texture = pendingUploads.front();
+			size_t size = static_cast<size_t>(texture.width) * texture.height * texture.channels;
+			// The first texture always goes, one bigger than the whole budget would never be uploaded otherwise
+			if (uploadedBytes > 0 && uploadedBytes + size > MIRIEL_TEXTURE_UPLOAD_BUDGET_BYTES) { break; }
+
+			uploadTexture(texture);
+			uploadedBytes += size;
+			texturesStreamed++;
+			pendingUploads.pop_front();
+
+			if (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= MIRIEL_TEXTURE_UPLOAD_BUDGET_MS) { break; }
+		}
+
+		if (pendingUploads.empty() && textureDecodes.done() && decodedTextures.empty()) {
+			MIRIEL_LOG(Debug, OpenGL, "Finished Streaming {} Textures.", texturesStreamed);
+			texturesStreamed = 0;
+		}
+	}
+
+	void OpenGLCore::uploadTexture(const DecodedTexture& texture) {
+		MIRIEL_LOG(Trace, OpenGL, "Uploading Texture: {} ({}x{})", texture.name, texture.width, texture.height);
+
+		GLenum format = GL_RGBA;
+		if (texture.channels == 1) {
 			format = GL_RED;
-		} else if (texChannels == 3) {
+		} else if (texture.channels == 2) {
+			format = GL_RG;
+		} else if (texture.channels == 3) {
 			format = GL_RGB;
-		} else if (texChannels == 4) {
-			format = GL_RGBA;
 		}
 
-		glBindTexture(GL_TEXTURE_2D, texID);
-		glTexImage2D(GL_TEXTURE_2D, 0, format, texWidth, texHeight, 0, format, GL_UNSIGNED_BYTE, pixels);
+		size_t size = static_cast<size_t>(texture.width) * texture.height * texture.channels;
+
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, textureUploadPBO);
+		// Orphaning the old storage means we never wait on the driver still reading last upload out of it
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+		void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (!mapped) {
+			MIRIEL_LOG(Error, OpenGL, "Failed to Map Upload Buffer for Texture: {}.", texture.name);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			return;
+		}
+		std::memcpy(mapped, texture.pixels.get(), size);
+		if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+			MIRIEL_LOG(Warning, OpenGL, "Upload Buffer Was Lost While Copying Texture: {}.", texture.name);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			return;
+		}
+
+		// stb rows are tightly packed, RGB and single channel widths aren't always a multiple of 4
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glBindTexture(GL_TEXTURE_2D, texture.ID);
+		// With a PBO bound the data pointer is an offset into it, the copy happens on the GPU's time
+		glTexImage2D(GL_TEXTURE_2D, 0, format, texture.width, texture.height, 0, format, GL_UNSIGNED_BYTE, (void*)0);
 		glGenerateMipmap(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	void OpenGLCore::setGLThread(std::thread::id id) {
+		glThreadID = id;
+	}
 
-		stbi_image_free(pixels);
+	bool OpenGLCore::isGLThread() const {
+		return std::this_thread::get_id() == glThreadID.load();
+	}
 
-		return texID;
+	void OpenGLCore::invokeGL(const std::function<void()>& command) {
+		if (isGLThread()) {
+			command();
+			return;
+		}
+
+		// Blocking, so command can keep pointing at the caller's locals and exceptions make it back to the caller
+		std::promise<void> finished;
+		std::future<void> result = finished.get_future();
+		glCommands.push([&command, &finished]() {
+			try {
+				command();
+				finished.set_value();
+			} catch (...) {
+				finished.set_exception(std::current_exception());
+			}
+		});
+		result.get();
+	}
+
+	size_t OpenGLCore::runGLCommands() {
+		std::vector<std::function<void()>> commands;
+		glCommands.drain_into(commands);
+		for (auto& command : commands) {
+			command();
+		}
+		return commands.size();
 	}
 
 	std::shared_ptr<MirielEngine::Core::Scene> OpenGLCore::getScene() {
@@ -0,0 +1,161 @@
+#include "OpenGL/Engine/Core/OpenGLRenderThread.hpp"
+
+#include <utility>
+
+#include "DearImGui/imgui_impl_opengl3.h"
+#include "Utils/MirielEngineLogger.hpp"
+
+namespace MirielEngine::OpenGL {
+	OpenGLRenderThread::OpenGLRenderThread(GLFWwindow* w, OpenGLCore* c) : window(w), core(c) {
+		running = false;
+		writeIndex = 0;
+		publishedIndex = 1;
+		readIndex = 2;
+		hasPublished = false;
+		framesRendered = 0;
+		framesDropped = 0;
+	}
+
+	OpenGLRenderThread::~OpenGLRenderThread() {
+		stop();
+		for (RenderSnapshot& snapshot : snapshots) {
+			for (ImDrawList* list : snapshot.guiDrawLists) {
+				IM_DELETE(list);
+			}
+		}
+	}
+
+	void OpenGLRenderThread::start() {
+		if (running) { return; }
+		MIRIEL_LOG(Info, OpenGL, "Starting Render Thread.");
+
+		// A context can only be current on one thread at a time
+		glfwMakeContextCurrent(NULL);
+		running = true;
+		thread = std::thread(&OpenGLRenderThread::renderLoop, this);
+		core->setGLThread(thread.get_id());
+	}
+
+	void OpenGLRenderThread::stop() {
+		if (!thread.joinable()) { return; }
+		MIRIEL_LOG(Info, OpenGL, "Stopping Render Thread.");
+
+		{
+			std::scoped_lock<std::mutex> lock(snapshotMtx);
+			running = false;
+		}
+		snapshotPublished.notify_all();
+		snapshotTaken.notify_all();
+		thread.join();
+
+		glfwMakeContextCurrent(window);
+		core->setGLThread(std::this_thread::get_id());
+		MIRIEL_LOG(Info, OpenGL, "Render Thread Drew {} Frames, {} Were Replaced Before it Got to Them.", framesRendered.load(), framesDropped.load());
+	}
+
+	void OpenGLRenderThread::renderLoop() {
+		glfwMakeContextCurrent(window);
+
+		while (running) {
+			core->runGLCommands();
+
+			if (!takeSnapshot()) {
+				// Wakes up now and then even without a new frame so invokeGL callers aren't left waiting
+				std::unique_lock<std::mutex> lock(snapshotMtx);
+				snapshotPublished.wait_for(lock, std::chrono::milliseconds(1), [this] { return hasPublished || !running; });
+				continue;
+			}
+
+			RenderSnapshot& snapshot = snapshots[readIndex];
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			core->draw(snapshot.scene);
+			if (snapshot.guiDrawData.Valid) {
+				ImGui_ImplOpenGL3_RenderDrawData(&snapshot.guiDrawData);
+			}
+			glfwSwapBuffers(window);
+			framesRendered.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// Anyone still stuck in invokeGL gets answered before the context goes back
+		core->runGLCommands();
+		glfwMakeContextCurrent(NULL);
+	}
+
+	bool OpenGLRenderThread::takeSnapshot() {
+		{
+			std::scoped_lock<std::mutex> lock(snapshotMtx);
+			if (!hasPublished) { return false; }
+			std::swap(readIndex, publishedIndex);
+			hasPublished = false;
+		}
+		snapshotTaken.notify_one();
+		return true;
+	}
+
+	void OpenGLRenderThread::publish(const ImDrawData* drawData) {
+		RenderSnapshot& snapshot = snapshots[writeIndex];
+		// Swapping keeps both vectors' capacity around, prepareFrame clears whatever it gets back
+		std::swap(snapshot.scene, core->getPreparedFrame());
+		copyDrawData(snapshot, drawData);
+
+		{
+			std::scoped_lock<std::mutex> lock(snapshotMtx);
+			if (hasPublished) {
+				framesDropped.fetch_add(1, std::memory_order_relaxed);
+				carryTransforms(snapshots[publishedIndex].scene, snapshot.scene);
+			}
+			std::swap(writeIndex, publishedIndex);
+			hasPublished = true;
+		}
+		snapshotPublished.notify_one();
+	}
+
+	void OpenGLRenderThread::waitForRender(std::chrono::milliseconds timeout) {
+		std::unique_lock<std::mutex> lock(snapshotMtx);
+		snapshotTaken.wait_for(lock, timeout, [this] { return !hasPublished || !running; });
+	}
+
+	void OpenGLRenderThread::carryTransforms(const FrameSnapshot& dropped, FrameSnapshot& next) {
+		// Transforms are only sent once when they change, a dropped frame's have to go out with the next one or they're lost
+		if (dropped.transformRanges.empty() || dropped.generation != next.generation) { return; }
+
+		// They go in front so anything edited again since still lands last
+		size_t shift = dropped.transformUploads.size();
+		for (TransformRange& range : next.transformRanges) {
+			range.uploadOffset += shift;
+		}
+		next.transformRanges.insert(next.transformRanges.begin(), dropped.transformRanges.begin(), dropped.transformRanges.end());
+		next.transformUploads.insert(next.transformUploads.begin(), dropped.transformUploads.begin(), dropped.transformUploads.end());
+	}
+
+	void OpenGLRenderThread::copyDrawData(RenderSnapshot& snapshot, const ImDrawData* drawData) {
+		ImDrawData& copy = snapshot.guiDrawData;
+		copy.Clear();
+		if (!drawData || !drawData->Valid) { return; }
+
+		// ImGui reuses its own lists next frame, so the buffers are copied into lists this snapshot owns
+		while (snapshot.guiDrawLists.size() < static_cast<size_t>(drawData->CmdListsCount)) {
+			snapshot.guiDrawLists.push_back(IM_NEW(ImDrawList)(drawData->CmdLists[0]->_Data));
+		}
+
+		for (int i = 0; i < drawData->CmdListsCount; i++) {
+			const ImDrawList* source = drawData->CmdLists[i];
+			ImDrawList* list = snapshot.guiDrawLists[i];
+			list->CmdBuffer = source->CmdBuffer;
+			list->IdxBuffer = source->IdxBuffer;
+			list->VtxBuffer = source->VtxBuffer;
+			list->Flags = source->Flags;
+			copy.CmdLists.push_back(list);
+		}
+
+		copy.Valid = true;
+		copy.CmdListsCount = drawData->CmdListsCount;
+		copy.TotalIdxCount = drawData->TotalIdxCount;
+		copy.TotalVtxCount = drawData->TotalVtxCount;
+		copy.DisplayPos = drawData->DisplayPos;
+		copy.DisplaySize = drawData->DisplaySize;
+		copy.FramebufferScale = drawData->FramebufferScale;
+		copy.OwnerViewport = drawData->OwnerViewport;
+	}
+}
\ No newline at end of file
@@ -61,6 +61,71 @@ namespace MirielEngine::OpenGL {
 		/*make a callback class that will take the window and scene and then make all callback functions*/
 
 		glfwGetWindowSize(window, &width, &height);
+
+		buildFrameGraph();
+		gui->setFrameGraph(frameGraph.get());
+
+		#if MIRIEL_RENDER_THREAD
+		// The ImGui backend makes its shaders and font texture on the first NewFrame, do that while this thread still has the context
+		ImGui_ImplOpenGL3_NewFrame();
+		renderThread = std::make_unique<MirielEngine::OpenGL::OpenGLRenderThread>(window, core.get());
+		renderThread->start();
+		#endif
+	}
+
+	void OpenGLApplication::buildFrameGraph() {
+		using enum MirielEngine::Utils::FrameResource;
+		using MirielEngine::Utils::StageAffinity;
+
+		frameGraph = std::make_unique<MirielEngine::Utils::FrameGraph>();
+
+		// ImGui's glfw callbacks feed input into the ImGui context while events are polled
+		frameGraph->addStage("Poll Events", {}, { Window, ImGuiFrame }, StageAffinity::MainThread, []() {
+			glfwPollEvents();
+		});
+		// GL work handed back from the job system (uploads, texture creation, finished imports) runs here, before anything draws
+		frameGraph->addStage("Main Thread Jobs", {}, { Scene, GPUResources }, StageAffinity::MainThread, []() {
+			MirielEngine::Utils::GlobalJobSystem->pumpMainThread();
+		});
+		// Widgets edit the scene directly and New Scene clears GL objects, so this stays on the main thread
+		frameGraph->addStage("Build GUI", { Window }, { Scene, GPUResources, ImGuiFrame }, StageAffinity::MainThread, [this]() {
+			#if MIRIEL_RENDER_THREAD
+			// Nothing for the GL backend to do per frame once its device objects exist, and the context isn't here anyway
+			gui->generateFrame([]() {});
+			#else
+			gui->generateFrame(ImGui_ImplOpenGL3_NewFrame);
+			#endif
+		});
+		frameGraph->addStage("Sync GPU Resources", {}, { Scene, GPUResources }, StageAffinity::MainThread, [this]() {
+			core->syncResources();
+		});
+		frameGraph->addStage("Prepare Frame", { Window, Scene, GPUResources }, { DrawList, Scene }, StageAffinity::Worker, [this]() {
+			core->prepareFrame(width, height);
+		});
+		// Only builds vertex and index lists, the GL side is Draw GUI
+		frameGraph->addStage("ImGui Render", {}, { ImGuiFrame, ImGuiDrawData }, StageAffinity::Worker, []() {
+			ImGui::Render();
+		});
+		#if MIRIEL_RENDER_THREAD
+		// Clearing, drawing and swapping all happen on the render thread from here
+		frameGraph->addStage("Publish Frame", { DrawList, ImGuiDrawData }, { Framebuffer }, StageAffinity::MainThread, [this]() {
+			renderThread->publish(ImGui::GetDrawData());
+		});
+		#else
+		frameGraph->addStage("Clear", {}, { Framebuffer }, StageAffinity::MainThread, []() {
+			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		});
+		frameGraph->addStage("Draw Scene", { DrawList, GPUResources }, { Framebuffer }, StageAffinity::MainThread, [this]() {
+			core->draw(core->getPreparedFrame());
+		});
+		frameGraph->addStage("Draw GUI", { ImGuiDrawData }, { Framebuffer }, StageAffinity::MainThread, []() {
+			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		});
+		frameGraph->addStage("Swap Buffers", {}, { Window, Framebuffer }, StageAffinity::MainThread, [this]() {
+			glfwSwapBuffers(window);
+		});
+		#endif
 	}
 
 	void OpenGLApplication::runApplication() {
@@ -73,22 +138,21 @@ namespace MirielEngine::OpenGL {
 		*
 		*/
 		while (!glfwWindowShouldClose(window)) {
-			glfwPollEvents();
-			glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-			core->draw(width, height);
-
-			gui->generateFrame(ImGui_ImplOpenGL3_NewFrame);
-			ImGui::Render();
-			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-			glfwSwapBuffers(window);
+			frameGraph->execute();
+			#if MIRIEL_RENDER_THREAD
+			// Stays roughly in step with the render thread, but a slow GPU frame only costs this thread a few ms
+			renderThread->waitForRender(std::chrono::milliseconds(4));
+			#endif
 		}
 
 		MirielEngine::Utils::GlobalLogger->log("Application has Exited Main Loop.");
 	}
 
 	void OpenGLApplication::cleanup() {
+		if (renderThread) {
+			// Everything below needs the context back on this thread
+			renderThread->stop();
+		}
 		MirielEngine::Utils::GlobalLogger->log("Shutting Down Backends for ImGui.");
 		ImGui_ImplOpenGL3_Shutdown();
 		ImGui_ImplGlfw_Shutdown();
@@ -101,6 +165,7 @@ namespace MirielEngine::OpenGL {
 		glfwTerminate();
 
 		/* Have to forcefully reset these to ensure that the scene share_ptr is released properly */
+		frameGraph.reset();
 		gui.reset();
 		core.reset();
 	}
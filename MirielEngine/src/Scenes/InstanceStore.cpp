@@ -0,0 +1,127 @@
+#include "Scenes/InstanceStore.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace MirielEngine::Core {
+	namespace {
+		// Swap-pop, same as the handle table does with its own arrays
+		template <typename T>
+		void removeAt(std::pmr::vector<T>& values, size_t i) {
+			if (i != values.size() - 1) { values[i] = values.back(); }
+			values.pop_back();
+		}
+
+		// Drops entries for the removed instance and renames the one that was moved into its place
+		void remapRemoved(std::pmr::vector<uint32_t>& list, uint32_t removed, uint32_t last) {
+			size_t kept = 0;
+			for (uint32_t i : list) {
+				if (i == removed) { continue; }
+				list[kept++] = i == last ? removed : i;
+			}
+			list.resize(kept);
+		}
+	}
+
+	InstanceStore::InstanceStore(std::pmr::memory_resource* resource)
+		: translations(resource), rotations(resource), orientations(resource), scales(resource), worldMatrices(resource),
+		  parents(resource), nodes(resource), shaderCombinations(resource), dirty(resource), changed(resource), moved(resource) {}
+
+	void InstanceStore::reserve(size_t count) {
+		handles.reserve(count);
+		translations.reserve(count);
+		rotations.reserve(count);
+		orientations.reserve(count);
+		scales.reserve(count);
+		worldMatrices.reserve(count);
+		parents.reserve(count);
+		nodes.reserve(count);
+		shaderCombinations.reserve(count);
+		dirty.reserve(count);
+	}
+
+	void InstanceStore::clear() {
+		handles.clear();
+		translations.clear();
+		rotations.clear();
+		orientations.clear();
+		scales.clear();
+		worldMatrices.clear();
+		parents.clear();
+		nodes.clear();
+		shaderCombinations.clear();
+		dirty.clear();
+		changed.clear();
+		moved.clear();
+	}
+
+	MirielEngine::Utils::DataStructures::SlotHandle InstanceStore::add(uint32_t shaderCombination, const glm::vec3& translation, const glm::vec3& rotation, const glm::vec3& scale) {
+		MirielEngine::Utils::DataStructures::SlotHandle handle = handles.add();
+		translations.push_back(translation);
+		rotations.push_back(rotation);
+		orientations.push_back(glm::quat(glm::radians(rotation)));
+		scales.push_back(scale);
+		worldMatrices.push_back(glm::mat4(1.0f));
+		parents.push_back(InstanceHandle{});
+		// Filled in once Scene::updateTransforms sees the instance count changed and rebuilds the hierarchy
+		nodes.push_back(InstanceRef::None);
+		shaderCombinations.push_back(shaderCombination);
+		dirty.push_back(0);
+
+		// Never been uploaded either, so a new instance goes through changed like any edit
+		markDirty(translations.size() - 1);
+		return handle;
+	}
+
+	bool InstanceStore::remove(MirielEngine::Utils::DataStructures::SlotHandle handle) {
+		size_t index = handles.remove(handle);
+		if (index == MirielEngine::Utils::DataStructures::HandleTable::npos) { return false; }
+
+		uint32_t last = static_cast<uint32_t>(size() - 1);
+		removeAt(translations, index);
+		removeAt(rotations, index);
+		removeAt(orientations, index);
+		removeAt(scales, index);
+		removeAt(worldMatrices, index);
+		removeAt(parents, index);
+		removeAt(nodes, index);
+		removeAt(shaderCombinations, index);
+		removeAt(dirty, index);
+		remapRemoved(changed, static_cast<uint32_t>(index), last);
+		remapRemoved(moved, static_cast<uint32_t>(index), last);
+		return true;
+	}
+
+	void InstanceStore::updateRotation(size_t i) {
+		orientations[i] = glm::quat(glm::radians(rotations[i]));
+	}
+
+	glm::mat4 InstanceStore::getLocalMatrix(size_t i) const {
+		// Same T * R * S as before, written out so there are no full translate and scale matrices to multiply through
+		glm::mat4 local = glm::mat4_cast(orientations[i]);
+		local[0] *= scales[i].x;
+		local[1] *= scales[i].y;
+		local[2] *= scales[i].z;
+		local[3] = glm::vec4(translations[i], 1.0f);
+		return local;
+	}
+
+	void InstanceStore::markDirty(size_t i) {
+		if (dirty[i]) { return; }
+		dirty[i] = 1;
+		changed.push_back(static_cast<uint32_t>(i));
+	}
+
+	void InstanceStore::markAllDirty() {
+		for (size_t i = 0; i < size(); i++) {
+			markDirty(i);
+		}
+	}
+
+	void InstanceStore::clearChanged() {
+		for (uint32_t i : changed) {
+			dirty[i] = 0;
+		}
+		changed.clear();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,375 @@
+#include "Scenes/MeshCache.hpp"
+
+#include <filesystem>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <type_traits>
+#include <string_view>
+#include <cctype>
+
+#include "Scenes/MeshOptimizer.hpp"
+#include "Utils/MappedFile.hpp"
+#include "Utils/MirielEngineLogger.hpp"
+
+namespace MirielEngine::Core {
+	namespace {
+		constexpr char MeshCacheMagic[4] = { 'M', 'M', 'S', 'H' };
+		// Bumped whenever the file layout or what an import does to the geometry changes, older files then just miss
+		constexpr uint32_t MeshCacheVersion = 1;
+
+		enum MeshCacheSection : uint32_t {
+			Vertices,
+			Indices,
+			Meshes,
+			NodeParents,
+			NodeLocals,
+			Textures,
+			SectionCount
+		};
+
+		struct MeshCacheHeader {
+			char magic[4];
+			uint32_t version;
+			uint64_t sourceHash;
+			uint64_t settingsHash;
+			uint32_t vertexCount;
+			uint32_t indexCount;
+			uint32_t meshCount;
+			uint32_t nodeCount;
+			uint32_t textureCount;
+			uint8_t vertexLayout;
+			uint8_t indexType;
+			uint8_t padding[2];
+			float vertexColor[3];
+			uint32_t reserved;
+			// From the start of the file, every section starts 16 byte aligned
+			uint64_t sectionOffsets[SectionCount];
+			uint64_t sectionSizes[SectionCount];
+		};
+
+		// Followed by the type's characters and then the path's, no terminators
+		struct TextureEntry {
+			uint32_t typeLength;
+			uint32_t pathLength;
+		};
+
+		static_assert(std::is_trivially_copyable_v<MeshRange>, "MeshRange is written to the cache as raw bytes.");
+
+		// Only has to notice changes, not stand up to anyone trying to collide it
+		uint64_t hashBytes(const void* data, size_t size, uint64_t h = 0xCBF29CE484222325ull) {
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			size_t i = 0;
+			for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+				uint64_t word;
+				std::memcpy(&word, bytes + i, sizeof(word));
+				h = (h ^ word) * 0x9E3779B97F4A7C15ull;
+				h ^= h >> 29;
+			}
+			for (; i < size; i++) {
+				h = (h ^ bytes[i]) * 0x100000001B3ull;
+			}
+			return h ^ (h >> 32);
+		}
+
+		size_t alignSection(size_t offset) {
+			return (offset + 15) & ~static_cast<size_t>(15);
+		}
+
+		bool sectionFits(const MeshCacheHeader& header, MeshCacheSection section, size_t expectedSize, size_t fileSize) {
+			uint64_t offset = header.sectionOffsets[section];
+			uint64_t size = header.sectionSizes[section];
+			return size == expectedSize && offset <= fileSize && size <= fileSize - offset;
+		}
+
+		template <typename T>
+		void copySection(const unsigned char* file, const MeshCacheHeader& header, MeshCacheSection section, std::pmr::vector<T>& out, size_t count) {
+			out.resize(count);
+			if (count > 0) { std::memcpy(out.data(), file + header.sectionOffsets[section], count * sizeof(T)); }
+		}
+
+		/*
+			Files the model pulls geometry or materials from, a .obj's mtllib and a .gltf's .bin buffers. Found by a plain
+			text scan rather than a real parse, anything it doesn't recognise (a .gltf's images, formats that reference
+			nothing) just isn't followed.
+		*/
+		std::vector<std::filesystem::path> findReferencedFiles(const std::filesystem::path& sourcePath, std::string_view text) {
+			std::vector<std::filesystem::path> references;
+			std::string extension = sourcePath.extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			std::filesystem::path directory = sourcePath.parent_path();
+
+			if (extension == ".obj") {
+				constexpr std::string_view keyword = "mtllib";
+				for (size_t lineStart = 0; lineStart < text.size();) {
+					size_t lineEnd = std::min(text.find('\n', lineStart), text.size());
+					std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+					lineStart = lineEnd + 1;
+
+					if (!line.starts_with(keyword) || line.size() == keyword.size() || !std::isspace(static_cast<unsigned char>(line[keyword.size()]))) { continue; }
+					// The rest of the line is the name, same as Assimp reads it
+					size_t nameStart = line.find_first_not_of(" \t", keyword.size());
+					size_t nameEnd = line.find_last_not_of(" \t\r");
+					if (nameStart == std::string_view::npos || nameEnd < nameStart) { continue; }
+					references.push_back(directory / std::string(line.substr(nameStart, nameEnd - nameStart + 1)));
+				}
+			} else if (extension == ".gltf") {
+				constexpr std::string_view keyword = "\"uri\"";
+				for (size_t at = text.find(keyword); at != std::string_view::npos; at = text.find(keyword, at + keyword.size())) {
+					size_t open = text.find('"', at + keyword.size());
+					size_t close = open == std::string_view::npos ? open : text.find('"', open + 1);
+					if (close == std::string_view::npos) { break; }
+					std::string_view uri = text.substr(open + 1, close - open - 1);
+					if (uri.ends_with(".bin")) { references.push_back(directory / std::string(uri)); }
+				}
+			}
+			return references;
+		}
+
+		// Largest of indices [first, first + count), read a value at a time since the mapping makes no promises about alignment
+		template <typename T>
+		uint32_t maxIndex(const unsigned char* indices, uint32_t first, uint32_t count) {
+			uint32_t largest = 0;
+			for (uint32_t i = first; i < first + count; i++) {
+				T index;
+				std::memcpy(&index, indices + static_cast<size_t>(i) * sizeof(T), sizeof(T));
+				largest = std::max<uint32_t>(largest, index);
+			}
+			return largest;
+		}
+	}
+
+	MeshCacheKey getMeshCacheKey(const std::string& objectName, unsigned int importFlags) {
+		MeshCacheKey key{ "", 0, 0 };
+
+		MirielEngine::Utils::MappedFile source;
+		if (!source.openReadOnly(objectName)) { return key; }
+		key.sourceHash = hashBytes(source.getData(), source.getSize());
+
+		// Editing a .mtl or .bin changes the import as much as editing the model does
+		std::string_view sourceText(static_cast<const char*>(source.getData()), source.getSize());
+		for (const std::filesystem::path& reference : findReferencedFiles(objectName, sourceText)) {
+			MirielEngine::Utils::MappedFile referenced;
+			if (referenced.openReadOnly(reference.string())) {
+				key.sourceHash = hashBytes(referenced.getData(), referenced.getSize(), key.sourceHash);
+			} else {
+				// Missing counts as well, the key changes again once the file turns up
+				std::string name = reference.generic_string();
+				key.sourceHash = hashBytes(name.data(), name.size(), key.sourceHash ^ 1);
+			}
+		}
+
+		uint64_t settings[] = {
+			importFlags, MIRIEL_OPTIMIZE_MESHES, MIRIEL_COMPACT_VERTICES, MIRIEL_VERTEX_CACHE_SIZE,
+			sizeof(Vertex), sizeof(CompactVertex), sizeof(MeshRange), MeshCacheVersion
+		};
+		key.settingsHash = hashBytes(settings, sizeof(settings));
+
+		// Named after the source so the folder is readable, the path hash keeps models with the same name apart
+		std::filesystem::path sourcePath(objectName);
+		std::string absolutePath = std::filesystem::absolute(sourcePath).generic_string();
+		std::ostringstream os;
+		os << sourcePath.stem().string() << "-" << std::hex << hashBytes(absolutePath.data(), absolutePath.size()) << ".mmesh";
+		key.cachePath = (std::filesystem::current_path() / "Cache" / os.str()).string();
+		return key;
+	}
+
+	bool loadCachedObject(const MeshCacheKey& key, Object* object, const TextureLoadFunction& textureLoader) {
+		if (key.cachePath.empty()) { return false; }
+
+		MirielEngine::Utils::MappedFile cached;
+		if (!cached.openReadOnly(key.cachePath)) { return false; }
+
+		const unsigned char* file = static_cast<const unsigned char*>(cached.getData());
+		size_t fileSize = cached.getSize();
+		MeshCacheHeader header;
+		if (fileSize < sizeof(header)) { return false; }
+		std::memcpy(&header, file, sizeof(header));
+
+		if (std::memcmp(header.magic, MeshCacheMagic, sizeof(MeshCacheMagic)) != 0 || header.version != MeshCacheVersion) { return false; }
+		if (header.sourceHash != key.sourceHash || header.settingsHash != key.settingsHash) {
+			MIRIEL_LOG(Debug, Loader, "Cooked Copy {} is Out of Date.", key.cachePath);
+			return false;
+		}
+
+		// Everything is checked before object is touched, a bad file just means importing it again
+		bool compact = header.vertexLayout == static_cast<uint8_t>(VertexLayout::Compact);
+		bool shortIndices = header.indexType == static_cast<uint8_t>(IndexType::UInt16);
+		size_t vertexSize = compact ? sizeof(CompactVertex) : sizeof(Vertex);
+		size_t indexSize = shortIndices ? sizeof(uint16_t) : sizeof(unsigned int);
+		if (!sectionFits(header, Vertices, header.vertexCount * vertexSize, fileSize) ||
+			!sectionFits(header, Indices, header.indexCount * indexSize, fileSize) ||
+			!sectionFits(header, Meshes, header.meshCount * sizeof(MeshRange), fileSize) ||
+			!sectionFits(header, NodeParents, header.nodeCount * sizeof(uint32_t), fileSize) ||
+			!sectionFits(header, NodeLocals, header.nodeCount * sizeof(glm::mat4), fileSize) ||
+			!sectionFits(header, Textures, header.sectionSizes[Textures], fileSize)) {
+			MIRIEL_LOG(Warning, Loader, "Cooked Copy {} is Damaged, Importing Again.", key.cachePath);
+			return false;
+		}
+
+		std::vector<MeshRange> meshes(header.meshCount);
+		if (!meshes.empty()) { std::memcpy(meshes.data(), file + header.sectionOffsets[Meshes], meshes.size() * sizeof(MeshRange)); }
+		const unsigned char* indices = file + header.sectionOffsets[Indices];
+		for (const MeshRange& mesh : meshes) {
+			bool valid = mesh.node < header.nodeCount && mesh.baseVertex >= 0 && static_cast<uint32_t>(mesh.baseVertex) <= header.vertexCount &&
+						 static_cast<uint64_t>(mesh.firstIndex) + mesh.indexCount <= header.indexCount;
+			// Every index the draw can fetch has to land inside the vertex buffer, the driver won't check it for us
+			if (valid && mesh.indexCount > 0) {
+				uint32_t largest = shortIndices ? maxIndex<uint16_t>(indices, mesh.firstIndex, mesh.indexCount) : maxIndex<unsigned int>(indices, mesh.firstIndex, mesh.indexCount);
+				valid = static_cast<uint64_t>(mesh.baseVertex) + largest < header.vertexCount;
+			}
+			if (!valid) {
+				MIRIEL_LOG(Warning, Loader, "Cooked Copy {} is Damaged, Importing Again.", key.cachePath);
+				return false;
+			}
+		}
+
+		std::vector<uint32_t> parents(header.nodeCount);
+		if (!parents.empty()) { std::memcpy(parents.data(), file + header.sectionOffsets[NodeParents], parents.size() * sizeof(uint32_t)); }
+		for (uint32_t i = 0; i < parents.size(); i++) {
+			if (parents[i] != TransformHierarchy::NoParent && parents[i] >= i) {
+				MIRIEL_LOG(Warning, Loader, "Cooked Copy {} is Damaged, Importing Again.", key.cachePath);
+				return false;
+			}
+		}
+
+		std::vector<std::pair<std::string, std::string>> textures;
+		const unsigned char* texture = file + header.sectionOffsets[Textures];
+		const unsigned char* texturesEnd = texture + header.sectionSizes[Textures];
+		for (uint32_t i = 0; i < header.textureCount; i++) {
+			TextureEntry entry;
+			bool fits = static_cast<size_t>(texturesEnd - texture) >= sizeof(entry);
+			if (fits) {
+				std::memcpy(&entry, texture, sizeof(entry));
+				texture += sizeof(entry);
+				fits = static_cast<size_t>(texturesEnd - texture) >= static_cast<size_t>(entry.typeLength) + entry.pathLength;
+			}
+			if (!fits) {
+				MIRIEL_LOG(Warning, Loader, "Cooked Copy {} is Damaged, Importing Again.", key.cachePath);
+				return false;
+			}
+			textures.emplace_back(std::string(reinterpret_cast<const char*>(texture), entry.typeLength),
+								  std::string(reinterpret_cast<const char*>(texture) + entry.typeLength, entry.pathLength));
+			texture += entry.typeLength + entry.pathLength;
+		}
+
+		// One copy per stream, already in the layout the backend uploads
+		object->vertexLayout = compact ? VertexLayout::Compact : VertexLayout::Full;
+		object->indexType = shortIndices ? IndexType::UInt16 : IndexType::UInt32;
+		object->vertexColor = glm::vec3(header.vertexColor[0], header.vertexColor[1], header.vertexColor[2]);
+		if (compact) {
+			copySection(file, header, Vertices, object->compactVertices, header.vertexCount);
+		} else {
+			copySection(file, header, Vertices, object->vertices, header.vertexCount);
+		}
+		if (shortIndices) {
+			copySection(file, header, Indices, object->shortIndices, header.indexCount);
+		} else {
+			copySection(file, header, Indices, object->indices, header.indexCount);
+		}
+		object->meshes.assign(meshes.begin(), meshes.end());
+
+		const unsigned char* locals = file + header.sectionOffsets[NodeLocals];
+		object->nodes.reserve(header.nodeCount);
+		for (uint32_t i = 0; i < header.nodeCount; i++) {
+			glm::mat4 local;
+			std::memcpy(&local, locals + i * sizeof(glm::mat4), sizeof(glm::mat4));
+			object->nodes.add(parents[i], local);
+		}
+		object->nodes.propagate();
+		object->nodesMoved = true;
+
+		for (const auto& [type, path] : textures) {
+			Texture loaded{};
+			loaded.ID = textureLoader ? textureLoader(path) : 0;
+			loaded.type = MirielEngine::Utils::GlobalStringInterner->intern(type);
+			loaded.path = aiString(path);
+			object->textures.push_back(loaded);
+		}
+		return true;
+	}
+
+	bool cookObject(const MeshCacheKey& key, const Object& object) {
+		if (key.cachePath.empty()) { return false; }
+
+		MeshCacheHeader header{};
+		std::memcpy(header.magic, MeshCacheMagic, sizeof(MeshCacheMagic));
+		header.version = MeshCacheVersion;
+		header.sourceHash = key.sourceHash;
+		header.settingsHash = key.settingsHash;
+		header.vertexLayout = static_cast<uint8_t>(object.vertexLayout);
+		header.indexType = static_cast<uint8_t>(object.indexType);
+		header.vertexColor[0] = object.vertexColor.x;
+		header.vertexColor[1] = object.vertexColor.y;
+		header.vertexColor[2] = object.vertexColor.z;
+
+		// Only what gets uploaded, the other layout's copy is left behind
+		bool compact = object.vertexLayout == VertexLayout::Compact;
+		bool shortIndices = object.indexType == IndexType::UInt16;
+		header.vertexCount = static_cast<uint32_t>(compact ? object.compactVertices.size() : object.vertices.size());
+		header.indexCount = static_cast<uint32_t>(shortIndices ? object.shortIndices.size() : object.indices.size());
+		header.meshCount = static_cast<uint32_t>(object.meshes.size());
+		header.nodeCount = static_cast<uint32_t>(object.nodes.size());
+		header.textureCount = static_cast<uint32_t>(object.textures.size());
+
+		std::vector<unsigned char> textureBytes;
+		for (const Texture& texture : object.textures) {
+			const std::string& type = MirielEngine::Utils::GlobalStringInterner->get(texture.type);
+			std::string path = texture.path.C_Str();
+			TextureEntry entry{ static_cast<uint32_t>(type.size()), static_cast<uint32_t>(path.size()) };
+			const unsigned char* entryBytes = reinterpret_cast<const unsigned char*>(&entry);
+			textureBytes.insert(textureBytes.end(), entryBytes, entryBytes + sizeof(entry));
+			textureBytes.insert(textureBytes.end(), type.begin(), type.end());
+			textureBytes.insert(textureBytes.end(), path.begin(), path.end());
+		}
+
+		const void* sections[SectionCount] = {
+			compact ? static_cast<const void*>(object.compactVertices.data()) : static_cast<const void*>(object.vertices.data()),
+			shortIndices ? static_cast<const void*>(object.shortIndices.data()) : static_cast<const void*>(object.indices.data()),
+			object.meshes.data(),
+			object.nodes.parents.data(),
+			object.nodes.locals.data(),
+			textureBytes.data()
+		};
+		header.sectionSizes[Vertices] = header.vertexCount * (compact ? sizeof(CompactVertex) : sizeof(Vertex));
+		header.sectionSizes[Indices] = header.indexCount * (shortIndices ? sizeof(uint16_t) : sizeof(unsigned int));
+		header.sectionSizes[Meshes] = header.meshCount * sizeof(MeshRange);
+		header.sectionSizes[NodeParents] = header.nodeCount * sizeof(uint32_t);
+		header.sectionSizes[NodeLocals] = header.nodeCount * sizeof(glm::mat4);
+		header.sectionSizes[Textures] = textureBytes.size();
+
+		size_t fileSize = sizeof(header);
+		for (uint32_t section = 0; section < SectionCount; section++) {
+			header.sectionOffsets[section] = alignSection(fileSize);
+			fileSize = header.sectionOffsets[section] + header.sectionSizes[section];
+		}
+
+		std::error_code ec;
+		std::filesystem::create_directories(std::filesystem::path(key.cachePath).parent_path(), ec);
+		std::string temporaryPath = key.cachePath + ".tmp";
+		{
+			MirielEngine::Utils::MappedFile cooked;
+			if (!cooked.openReadWrite(temporaryPath, fileSize)) {
+				MIRIEL_LOG(Warning, Loader, "Couldn't Write Cooked Copy {}.", key.cachePath);
+				return false;
+			}
+
+			unsigned char* file = static_cast<unsigned char*>(cooked.getData());
+			std::memset(file, 0, fileSize);
+			std::memcpy(file, &header, sizeof(header));
+			for (uint32_t section = 0; section < SectionCount; section++) {
+				if (header.sectionSizes[section] > 0) { std::memcpy(file + header.sectionOffsets[section], sections[section], header.sectionSizes[section]); }
+			}
+			cooked.flushAsync();
+		}
+
+		std::filesystem::rename(temporaryPath, key.cachePath, ec);
+		if (ec) {
+			MIRIEL_LOG(Warning, Loader, "Couldn't Write Cooked Copy {}.", key.cachePath);
+			std::filesystem::remove(temporaryPath, ec);
+			return false;
+		}
+		return true;
+	}
+}
\ No newline at end of file
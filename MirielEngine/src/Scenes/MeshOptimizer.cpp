@@ -0,0 +1,308 @@
+#include "Scenes/MeshOptimizer.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <cmath>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "Utils/FlatHashMap.hpp"
+
+namespace MirielEngine::Core {
+	namespace {
+		constexpr uint32_t NoVertex = std::numeric_limits<uint32_t>::max();
+
+		// Welding compares raw bytes, padding would make identical vertices look different
+		static_assert(sizeof(Vertex) == 11 * sizeof(float), "Vertex has padding, welding would miss duplicates.");
+
+		static_assert(sizeof(CompactVertex) == 16, "CompactVertex should pack down to 16 bytes.");
+
+		// One mesh's worth of vertices and indices, several MeshRanges point at the same one when nodes share a mesh
+		struct MeshSpan {
+			uint32_t firstIndex;
+			uint32_t indexCount;
+			int32_t baseVertex;
+			uint32_t vertexCount;
+		};
+
+		uint64_t spanKey(uint32_t firstIndex, int32_t baseVertex) {
+			return (static_cast<uint64_t>(firstIndex) << 32) | static_cast<uint32_t>(baseVertex);
+		}
+
+		size_t countCacheMisses(const unsigned int* indices, size_t indexCount, size_t vertexCount, size_t cacheSize) {
+			// A vertex is still in a FIFO cache while fewer than cacheSize misses have happened since it was loaded
+			std::vector<size_t> loadedAt(vertexCount, 0);
+			size_t time = cacheSize + 1;
+			size_t misses = 0;
+			for (size_t i = 0; i < indexCount; i++) {
+				unsigned int v = indices[i];
+				if (time - loadedAt[v] > cacheSize) {
+					loadedAt[v] = time++;
+					misses++;
+				}
+			}
+			return misses;
+		}
+
+		size_t hashVertex(const Vertex& vertex) {
+			uint32_t words[11];
+			std::memcpy(words, &vertex, sizeof(words));
+			uint64_t h = 0;
+			for (uint32_t word : words) {
+				h = (h ^ word) * 0x100000001B3ull;
+			}
+			return static_cast<size_t>(h ^ (h >> 29));
+		}
+
+		// remap[v] is v's welded index, returns the first vertex of each welded group in order
+		std::vector<uint32_t> weldVertices(const Vertex* vertices, size_t vertexCount, std::vector<uint32_t>& remap) {
+			size_t capacity = 16;
+			while (capacity < vertexCount * 2) { capacity *= 2; }
+			std::vector<uint32_t> table(capacity, NoVertex);
+			std::vector<uint32_t> unique;
+			remap.assign(vertexCount, NoVertex);
+
+			for (uint32_t v = 0; v < vertexCount; v++) {
+				size_t slot = hashVertex(vertices[v]) & (capacity - 1);
+				while (table[slot] != NoVertex && std::memcmp(&vertices[table[slot]], &vertices[v], sizeof(Vertex)) != 0) {
+					slot = (slot + 1) & (capacity - 1);
+				}
+
+				if (table[slot] == NoVertex) {
+					table[slot] = v;
+					remap[v] = static_cast<uint32_t>(unique.size());
+					unique.push_back(v);
+				} else {
+					remap[v] = remap[table[slot]];
+				}
+			}
+			return unique;
+		}
+
+		/*
+			Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+			Emits every triangle around one vertex at a time and then moves on to whichever of the vertices just emitted
+			is still in the cache and has triangles left, falling back to recently used vertices and then a cursor when
+			it runs into a dead end. Linear in the triangle count.
+		*/
+		void tipsify(unsigned int* indices, size_t indexCount, size_t vertexCount, size_t cacheSize) {
+			size_t triangleCount = indexCount / 3;
+
+			// Triangles around each vertex, adjacency[adjacencyStarts[v]] to adjacency[adjacencyStarts[v + 1]]
+			std::vector<uint32_t> liveTriangles(vertexCount, 0);
+			for (size_t i = 0; i < indexCount; i++) {
+				liveTriangles[indices[i]]++;
+			}
+			std::vector<uint32_t> adjacencyStarts(vertexCount + 1, 0);
+			for (size_t v = 0; v < vertexCount; v++) {
+				adjacencyStarts[v + 1] = adjacencyStarts[v] + liveTriangles[v];
+			}
+			std::vector<uint32_t> adjacency(indexCount);
+			std::vector<uint32_t> cursor(adjacencyStarts.begin(), adjacencyStarts.end() - 1);
+			for (size_t i = 0; i < indexCount; i++) {
+				adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+
+			std::vector<size_t> cachedAt(vertexCount, 0);
+			std::vector<uint8_t> emitted(triangleCount, 0);
+			std::vector<uint32_t> deadEnds;
+			std::vector<uint32_t> candidates;
+			std::vector<unsigned int> output;
+			output.reserve(indexCount);
+
+			size_t time = cacheSize + 1;
+			size_t nextVertex = 0;
+			uint32_t fanning = indices[0];
+			while (fanning != NoVertex) {
+				candidates.clear();
+				for (uint32_t a = adjacencyStarts[fanning]; a < adjacencyStarts[fanning + 1]; a++) {
+					uint32_t triangle = adjacency[a];
+					if (emitted[triangle]) { continue; }
+					emitted[triangle] = 1;
+
+					for (size_t corner = 0; corner < 3; corner++) {
+						unsigned int v = indices[triangle * 3 + corner];
+						output.push_back(v);
+						deadEnds.push_back(v);
+						candidates.push_back(v);
+						liveTriangles[v]--;
+						if (time - cachedAt[v] > cacheSize) {
+							cachedAt[v] = time++;
+						}
+					}
+				}
+
+				// Best candidate is the one that's been in the cache longest and will still be there after its own triangles
+				fanning = NoVertex;
+				size_t bestPriority = 0;
+				bool found = false;
+				for (uint32_t v : candidates) {
+					if (liveTriangles[v] == 0) { continue; }
+					size_t priority = 0;
+					if (time - cachedAt[v] + 2 * liveTriangles[v] <= cacheSize) {
+						priority = time - cachedAt[v];
+					}
+					if (!found || priority > bestPriority) {
+						fanning = v;
+						bestPriority = priority;
+						found = true;
+					}
+				}
+
+				if (found) { continue; }
+				while (!deadEnds.empty()) {
+					uint32_t v = deadEnds.back();
+					deadEnds.pop_back();
+					if (liveTriangles[v] > 0) {
+						fanning = v;
+						break;
+					}
+				}
+				if (fanning != NoVertex) { continue; }
+				while (nextVertex < vertexCount) {
+					if (liveTriangles[nextVertex] > 0) {
+						fanning = static_cast<uint32_t>(nextVertex);
+						break;
+					}
+					nextVertex++;
+				}
+			}
+
+			std::copy(output.begin(), output.end(), indices);
+		}
+	}
+
+	VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, size_t cacheSize) {
+		size_t misses = countCacheMisses(indices, indexCount, vertexCount, cacheSize);
+		return VertexCacheStats{
+			indexCount < 3 ? 0.0 : static_cast<double>(misses) / static_cast<double>(indexCount / 3),
+			vertexCount == 0 ? 0.0 : static_cast<double>(misses) / static_cast<double>(vertexCount)
+		};
+	}
+
+	MeshOptimizationStats optimizeObject(Object* object) {
+		MeshOptimizationStats stats{ VertexCacheStats{ 0.0, 0.0 }, VertexCacheStats{ 0.0, 0.0 }, object->vertices.size(), object->vertices.size() };
+		if (object->indices.empty() || object->meshes.empty()) { return stats; }
+
+		// processMesh lays meshes out back to back, so each one's vertices run up to where the next one starts
+		std::vector<MeshSpan> spans;
+		MirielEngine::Utils::DataStructures::FlatHashMap<uint64_t, int32_t> newBaseVertices;
+		for (const MeshRange& range : object->meshes) {
+			if (newBaseVertices.insert(spanKey(range.firstIndex, range.baseVertex), 0)) {
+				spans.push_back(MeshSpan{ range.firstIndex, range.indexCount, range.baseVertex, 0 });
+			}
+		}
+		std::sort(spans.begin(), spans.end(), [](const MeshSpan& a, const MeshSpan& b) { return a.baseVertex < b.baseVertex; });
+		for (size_t i = 0; i < spans.size(); i++) {
+			size_t end = i + 1 < spans.size() ? static_cast<size_t>(spans[i + 1].baseVertex) : object->vertices.size();
+			spans[i].vertexCount = static_cast<uint32_t>(end - spans[i].baseVertex);
+		}
+
+		std::pmr::vector<Vertex> vertices(object->vertices.get_allocator());
+		vertices.reserve(object->vertices.size());
+		size_t missesBefore = 0;
+		size_t missesAfter = 0;
+		size_t triangles = 0;
+		std::vector<uint32_t> remap;
+		std::vector<uint32_t> fetchOrder;
+
+		for (const MeshSpan& span : spans) {
+			unsigned int* indices = object->indices.data() + span.firstIndex;
+			const Vertex* meshVertices = object->vertices.data() + span.baseVertex;
+			missesBefore += countCacheMisses(indices, span.indexCount, span.vertexCount, MIRIEL_VERTEX_CACHE_SIZE);
+			triangles += span.indexCount / 3;
+
+			std::vector<uint32_t> unique = weldVertices(meshVertices, span.vertexCount, remap);
+			for (uint32_t i = 0; i < span.indexCount; i++) {
+				indices[i] = remap[indices[i]];
+			}
+
+			// Points or lines mixed in would throw the triangles out of step
+			if (span.indexCount > 0 && span.indexCount % 3 == 0) {
+				tipsify(indices, span.indexCount, unique.size(), MIRIEL_VERTEX_CACHE_SIZE);
+			}
+
+			// Vertices in the order the triangles first reach them, anything no triangle uses is dropped
+			int32_t baseVertex = static_cast<int32_t>(vertices.size());
+			fetchOrder.assign(unique.size(), NoVertex);
+			for (uint32_t i = 0; i < span.indexCount; i++) {
+				uint32_t& fetched = fetchOrder[indices[i]];
+				if (fetched == NoVertex) {
+					fetched = static_cast<uint32_t>(vertices.size()) - baseVertex;
+					vertices.push_back(meshVertices[unique[indices[i]]]);
+				}
+				indices[i] = fetched;
+			}
+
+			missesAfter += countCacheMisses(indices, span.indexCount, vertices.size() - baseVertex, MIRIEL_VERTEX_CACHE_SIZE);
+			*newBaseVertices.find(spanKey(span.firstIndex, span.baseVertex)) = baseVertex;
+		}
+
+		for (MeshRange& range : object->meshes) {
+			range.baseVertex = *newBaseVertices.find(spanKey(range.firstIndex, range.baseVertex));
+		}
+
+		if (triangles > 0) {
+			stats.before = VertexCacheStats{ static_cast<double>(missesBefore) / triangles, static_cast<double>(missesBefore) / object->vertices.size() };
+			stats.after = VertexCacheStats{ static_cast<double>(missesAfter) / triangles, vertices.empty() ? 0.0 : static_cast<double>(missesAfter) / vertices.size() };
+		}
+		stats.verticesAfter = vertices.size();
+		object->vertices = std::move(vertices);
+		return stats;
+	}
+
+	bool packVertices(Object* object) {
+		if (object->vertices.empty()) { return false; }
+
+		glm::vec3 color = object->vertices[0].color;
+		for (const Vertex& vertex : object->vertices) {
+			if (vertex.color != color) { return false; }
+		}
+
+		// Meshes used by several nodes get reached once per range, anything no range uses stays zeroed and is never drawn
+		object->compactVertices.assign(object->vertices.size(), CompactVertex{});
+		std::vector<uint8_t> packed(object->vertices.size(), 0);
+		for (const MeshRange& range : object->meshes) {
+			glm::vec3 extent = range.boundsMax - range.boundsMin;
+			// A flat axis has nothing to spread over, it all packs to 0 and the shader scales it by 0 again
+			glm::vec3 scale(extent.x > 0.0f ? 65535.0f / extent.x : 0.0f,
+							extent.y > 0.0f ? 65535.0f / extent.y : 0.0f,
+							extent.z > 0.0f ? 65535.0f / extent.z : 0.0f);
+
+			const unsigned int* indices = object->indices.data() + range.firstIndex;
+			for (uint32_t i = 0; i < range.indexCount; i++) {
+				size_t v = static_cast<size_t>(range.baseVertex) + indices[i];
+				if (packed[v]) { continue; }
+				packed[v] = 1;
+
+				const Vertex& vertex = object->vertices[v];
+				CompactVertex& compact = object->compactVertices[v];
+				glm::vec3 position = (vertex.aPos - range.boundsMin) * scale;
+				for (int axis = 0; axis < 3; axis++) {
+					compact.position[axis] = static_cast<uint16_t>(std::lround(glm::clamp(position[axis], 0.0f, 65535.0f)));
+				}
+				compact.normal = glm::packSnorm3x10_1x2(glm::vec4(vertex.normal, 0.0f));
+				compact.texCoord = glm::packHalf2x16(vertex.texCoord);
+			}
+		}
+
+		object->vertexColor = color;
+		object->vertexLayout = VertexLayout::Compact;
+		return true;
+	}
+
+	bool narrowIndices(Object* object) {
+		if (object->indices.empty()) { return false; }
+
+		// 0xFFFF is left alone so it's still free if primitive restart ever gets turned on
+		unsigned int largest = *std::max_element(object->indices.begin(), object->indices.end());
+		if (largest >= 0xFFFF) { return false; }
+
+		object->shortIndices.assign(object->indices.begin(), object->indices.end());
+		object->indexType = IndexType::UInt16;
+		return true;
+	}
+}
\ No newline at end of file
@@ -3,6 +3,10 @@
 #include <iostream>
 #include <filesystem>
 #include <stack>
+#include <queue>
+#include <utility>
+#include <exception>
+#include <algorithm>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -14,7 +18,10 @@
 #include <nfd.h>
 
 #include "Scenes/ObjectLoader.hpp"
+#include "Scenes/MeshOptimizer.hpp"
+#include "Scenes/MeshCache.hpp"
 #include "Utils/MirielEngineLogger.hpp"
+#include "Utils/JobSystem.hpp"
 #include "CustomErrors/MirielEngineErrors.hpp"
 
 /*
@@ -28,11 +35,31 @@ Note:	In order to make a 2D graphics engine, I would want to use orthographic pr
 */
 
 namespace MirielEngine::Core {
+	namespace {
+		glm::mat4 toMat4(const aiMatrix4x4& m) {
+			// Assimp matrices are row major, glm takes columns
+			return glm::mat4(m.a1, m.b1, m.c1, m.d1,
+							 m.a2, m.b2, m.c2, m.d2,
+							 m.a3, m.b3, m.c3, m.d3,
+							 m.a4, m.b4, m.c4, m.d4);
+		}
+	}
+
 	void loadObject(const std::string& objectName, MirielEngine::Core::Object* object, const TextureLoadFunction& textureLoader) {
 		std::string location = objectName;
-		MirielEngine::Utils::GlobalLogger->log("Loading in Object: " + objectName);
+		MIRIEL_LOG(Debug, Loader, "Loading in Object: {}", objectName);
+		constexpr unsigned int importFlags = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals;
+
+#if MIRIEL_MESH_CACHE
+		MeshCacheKey cacheKey = getMeshCacheKey(objectName, importFlags);
+		if (loadCachedObject(cacheKey, object, textureLoader)) {
+			MIRIEL_LOG(Debug, Loader, "Loaded {} From its Cooked Copy.", objectName);
+			return;
+		}
+#endif
+
 		Assimp::Importer importer;
-		const aiScene* scene = importer.ReadFile(location, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals);
+		const aiScene* scene = importer.ReadFile(location, importFlags);
 
 		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
 			std::ostringstream os;
@@ -41,44 +68,143 @@ namespace MirielEngine::Core {
 		}
 
 		processNode(scene->mRootNode, scene, object, textureLoader);
+
+#if MIRIEL_OPTIMIZE_MESHES
+		MeshOptimizationStats stats = optimizeObject(object);
+		MIRIEL_LOG(Debug, Loader, "Optimized {}: {} Vertices Down to {}, ACMR {} to {}, ATVR {} to {}.", objectName, stats.verticesBefore, stats.verticesAfter, stats.before.ACMR, stats.after.ACMR, stats.before.ATVR, stats.after.ATVR);
+#endif
+
+#if MIRIEL_COMPACT_VERTICES
+		// Every vertex the GPU fetches shrinks by the same ratio, so this is the bandwidth saving too
+		if (packVertices(object)) {
+			MIRIEL_LOG(Debug, Loader, "Packed {}: {} Vertex Bytes Down to {}, {} to {} per Vertex.", objectName, object->vertices.size() * sizeof(Vertex),
+					   object->compactVertices.size() * sizeof(CompactVertex), sizeof(Vertex), sizeof(CompactVertex));
+		} else {
+			MIRIEL_LOG(Debug, Loader, "{} Has Per Vertex Colours, Keeping Full Vertices.", objectName);
+		}
+#endif
+
+		if (narrowIndices(object)) {
+			MIRIEL_LOG(Debug, Loader, "{} Uses 16 Bit Indices, {} Index Bytes Down to {}.", objectName, object->indices.size() * sizeof(unsigned int), object->shortIndices.size() * sizeof(uint16_t));
+		}
+
+#if MIRIEL_MESH_CACHE
+		if (cookObject(cacheKey, *object)) {
+			MIRIEL_LOG(Debug, Loader, "Cooked {} Into {}.", objectName, cacheKey.cachePath);
+		}
+#endif
 	}
 
 	void processNode(aiNode* node, const aiScene* scene, MirielEngine::Core::Object* object, const TextureLoadFunction& textureLoader) {
-		for (unsigned int i = 0; i < node->mNumMeshes; i++) {
-			processMesh(scene->mMeshes[node->mMeshes[i]], scene, object, textureLoader);
+		// Sized for every mesh up front, growing one vertex at a time copies the whole model several times over and
+		// leaves every old buffer behind in the scene arena
+		size_t vertexTotal = 0;
+		size_t indexTotal = 0;
+		for (unsigned int i = 0; i < scene->mNumMeshes; i++) {
+			vertexTotal += scene->mMeshes[i]->mNumVertices;
+			indexTotal += static_cast<size_t>(scene->mMeshes[i]->mNumFaces) * 3;
 		}
+		object->vertices.reserve(object->vertices.size() + vertexTotal);
+		object->indices.reserve(object->indices.size() + indexTotal);
+
+		// Meshes used by more than one node are only loaded once, each node just gets its own range pointing at them
+		std::vector<MeshRange> loadedMeshes(scene->mNumMeshes, MeshRange{ 0, 0, -1, 0, glm::vec3(0.0f), glm::vec3(0.0f) });
+
+		// Breadth first so the nodes end up in the order TransformHierarchy wants them
+		std::queue<std::pair<aiNode*, uint32_t>> nodes;
+		nodes.push({ node, TransformHierarchy::NoParent });
+		while (!nodes.empty()) {
+			auto [current, parent] = nodes.front();
+			nodes.pop();
 
-		for (unsigned int i = 0; i < node->mNumChildren; i++) {
-			processNode(node->mChildren[i], scene, object, textureLoader);
+			uint32_t nodeIndex = object->nodes.add(parent, toMat4(current->mTransformation));
+
+			for (unsigned int i = 0; i < current->mNumMeshes; i++) {
+				unsigned int meshIndex = current->mMeshes[i];
+				if (loadedMeshes[meshIndex].baseVertex < 0) {
+					loadedMeshes[meshIndex] = processMesh(scene->mMeshes[meshIndex], scene, object, textureLoader);
+				}
+
+				MeshRange range = loadedMeshes[meshIndex];
+				range.node = nodeIndex;
+				object->meshes.push_back(range);
+			}
+
+			for (unsigned int i = 0; i < current->mNumChildren; i++) {
+				nodes.push({ current->mChildren[i], nodeIndex });
+			}
 		}
+
+		object->nodes.propagate();
+		object->nodesMoved = true;
 	}
 
-	void processMesh(aiMesh* mesh, const aiScene* scene, MirielEngine::Core::Object* object, const TextureLoadFunction& textureLoader) {
-		for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
-			Vertex v{};
-			v.aPos = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
-			v.normal = glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+	MeshRange processMesh(aiMesh* mesh, const aiScene* scene, MirielEngine::Core::Object* object, const TextureLoadFunction& textureLoader) {
+		// Indices stay relative to the mesh, baseVertex moves them onto its vertices when it's drawn
+		MeshRange range{};
+		range.firstIndex = static_cast<uint32_t>(object->indices.size());
+		range.baseVertex = static_cast<int32_t>(object->vertices.size());
+
+		// Each stream is copied in its own loop rather than building vertices field by field, every loop is a plain
+		// strided copy the compiler can vectorise for whatever it's targeting
+		size_t vertexCount = mesh->mNumVertices;
+		object->vertices.resize(object->vertices.size() + vertexCount);
+		Vertex* vertices = object->vertices.data() + range.baseVertex;
+
+		const aiVector3D* positions = mesh->mVertices;
+		for (size_t i = 0; i < vertexCount; i++) {
+			vertices[i].aPos = glm::vec3(positions[i].x, positions[i].y, positions[i].z);
+		}
 
-			if (mesh->mTextureCoords[0]) {
-				v.texCoord = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
+		range.boundsMin = vertexCount > 0 ? vertices[0].aPos : glm::vec3(0.0f);
+		range.boundsMax = range.boundsMin;
+		for (size_t i = 1; i < vertexCount; i++) {
+			range.boundsMin = glm::min(range.boundsMin, vertices[i].aPos);
+			range.boundsMax = glm::max(range.boundsMax, vertices[i].aPos);
+		}
+
+		// aiProcess_GenNormals fills these in for anything that had none, but a point cloud still won't have them
+		if (const aiVector3D* normals = mesh->mNormals) {
+			for (size_t i = 0; i < vertexCount; i++) {
+				vertices[i].normal = glm::vec3(normals[i].x, normals[i].y, normals[i].z);
 			}
+		}
 
-			v.color = glm::vec3(1.0f, 1.0f, 1.0f);
-			object->vertices.push_back(v);
+		if (const aiVector3D* texCoords = mesh->mTextureCoords[0]) {
+			for (size_t i = 0; i < vertexCount; i++) {
+				vertices[i].texCoord = glm::vec2(texCoords[i].x, texCoords[i].y);
+			}
 		}
 
-		for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
-			aiFace face = mesh->mFaces[i];
-			for (unsigned int j = 0; j < face.mNumIndices; j++) {
-				object->indices.push_back(face.mIndices[j]);
+		for (size_t i = 0; i < vertexCount; i++) {
+			vertices[i].color = glm::vec3(1.0f, 1.0f, 1.0f);
+		}
+
+		// Triangulated meshes are nearly always triangles only, anything with points or lines mixed in has to be counted first
+		size_t indexCount = static_cast<size_t>(mesh->mNumFaces) * 3;
+		if (mesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE) {
+			indexCount = 0;
+			for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+				indexCount += mesh->mFaces[i].mNumIndices;
 			}
 		}
 
+		object->indices.resize(object->indices.size() + indexCount);
+		unsigned int* indices = object->indices.data() + range.firstIndex;
+		for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+			// By reference, copying an aiFace copies its index array too
+			const aiFace& face = mesh->mFaces[i];
+			indices = std::copy_n(face.mIndices, face.mNumIndices, indices);
+		}
+
 		if (mesh->mMaterialIndex >= 0) {
 			aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
 			loadMaterials(material, aiTextureType_DIFFUSE, "texture_diffuse", object, textureLoader);
 			loadMaterials(material, aiTextureType_SPECULAR, "texture_specular", object, textureLoader);
 		}
+
+		range.indexCount = static_cast<uint32_t>(indexCount);
+		return range;
 	}
 
 	void loadMaterials(aiMaterial* material, aiTextureType type, std::string typeName,
@@ -89,31 +215,51 @@ namespace MirielEngine::Core {
 			aiString str;
 			material->GetTexture(type, i, &str);
 			Texture texture{};
-			texture.ID = textureLoader(str.C_Str());
-			texture.type = typeName;
+			// Without a loader (imports running on a worker) the path is kept and resolveObjectTextures fills the ID in later
+			texture.ID = textureLoader ? textureLoader(str.C_Str()) : 0;
+			texture.type = MirielEngine::Utils::GlobalStringInterner->intern(typeName);
 			texture.path = str;
 			object->textures.push_back(texture);
 		}
 	}
 
+	void resolveObjectTextures(MirielEngine::Core::Object* object, const TextureLoadFunction& textureLoader) {
+		for (Texture& texture : object->textures) {
+			if (texture.ID == 0) {
+				texture.ID = textureLoader(texture.path.C_Str());
+			}
+		}
+	}
+
+	bool isModelFile(const std::string& path) {
+		return path.ends_with(".obj") || path.ends_with(".gltf") || path.ends_with(".glb");
+	}
+
 	// TODO: Compress Texture Function?
 	void compressTexture(const std::string& textureName) { return; }
 
-	void Scene::loadSceneObject(std::ifstream* sceneFile, const std::string& objName) {
+	void Scene::loadSceneObject(std::ifstream* sceneFile, const std::string& objName, MirielEngine::Core::Object* importedObject) {
 		std::stack<char> braces{};
 		if (!loadedObjectNames.contains(objName)) {
-			Object object{};
-			MirielEngine::Core::loadObject(objName, &object, textureLoader);
+			Object object(&arena);
+			if (importedObject) {
+				// Imported on a worker already, only the textures still need the graphics API
+				object = std::move(*importedObject);
+				resolveObjectTextures(&object, textureLoader);
+			} else {
+				MirielEngine::Core::loadObject(objName, &object, textureLoader);
+			}
 			std::string tag;
 			*sceneFile >> tag;
 			braces.push(tag[0]);
 			object.path = objName;
 
-			this->objects.push_back(object);
-			this->loadedObjectNames[objName] = this->objects.size() - 1;
+			this->loadedObjectNames[objName] = this->objects.insert(std::move(object));
+			this->objectInstances.push_back(InstanceStore(&arena));
 		}
 
-		size_t currentObject = this->loadedObjectNames[objName];
+		MirielEngine::Utils::DataStructures::SlotHandle objectHandle = this->loadedObjectNames[objName];
+		size_t currentObject = this->objects.indexOf(objectHandle);
 
 		std::string defaultVertShader;
 		std::string defaultFragShader;
@@ -121,13 +267,12 @@ namespace MirielEngine::Core {
 		*sceneFile >> defaultVertShader;
 		*sceneFile >> defaultFragShader;
 
-		this->objects[currentObject].fragmentShaderName = defaultFragShader;
-		this->objects[currentObject].vertexShaderName = defaultVertShader;
+		MirielEngine::Utils::StringID defaultVert = MirielEngine::Utils::GlobalStringInterner->intern(defaultVertShader);
+		MirielEngine::Utils::StringID defaultFrag = MirielEngine::Utils::GlobalStringInterner->intern(defaultFragShader);
+		this->objects[currentObject].fragmentShader = defaultFrag;
+		this->objects[currentObject].vertexShader = defaultVert;
 
-		std::string shaderPair = defaultVertShader + " " + defaultFragShader;
-		if (!loadedShaderCombinations.contains(shaderPair)) {
-			loadedShaderCombinations[shaderPair] = Shader{ 0, false };
-		}
+		uint32_t defaultCombination = addShaderCombination(defaultVert, defaultFrag);
 
 		while (true) {
 			std::string tag;
@@ -143,11 +288,13 @@ namespace MirielEngine::Core {
 				break;
 			}
 
-			ObjectInstance instance{objects[currentObject]};
-
 			// push identity
-			instance.fragmentShaderName = defaultFragShader;
-			instance.vertexShaderName = defaultVertShader;
+			glm::vec3 translation(0.0f);
+			glm::vec3 rotation(0.0f);
+			glm::vec3 scale(1.0f);
+			std::string vertShader = defaultVertShader;
+			std::string fragShader = defaultFragShader;
+			InstanceRef parent{};
 
 			while (true) {
 				*sceneFile >> tag;
@@ -155,44 +302,46 @@ namespace MirielEngine::Core {
 				if (tag[0] == 't') {
 					std::string x, y, z;
 					*sceneFile >> x >> y >> z;
-					glm::vec3 v(std::stof(x), std::stof(y), std::stof(z));
-					instance.vTranslation = v;
-					instance.mTranslation = glm::translate(instance.mTranslation, v);
+					translation = glm::vec3(std::stof(x), std::stof(y), std::stof(z));
 				} else if (tag[0] == 'r') {
 					std::string x, y, z;
 					*sceneFile >> x >> y >> z;
-					glm::vec3 v(std::stof(x), std::stof(y), std::stof(z));
-					instance.vRotation = v;
-					instance.mRotation = glm::quat(glm::radians(v));
+					rotation = glm::vec3(std::stof(x), std::stof(y), std::stof(z));
 				} else if (tag[0] == 's') {
 					std::string x, y, z;
 					*sceneFile >> x >> y >> z;
-					glm::vec3 v(std::stof(x), std::stof(y), std::stof(z));
-					instance.vScale = v;
-					instance.mScale = glm::scale(instance.mScale, instance.vScale);
+					scale = glm::vec3(std::stof(x), std::stof(y), std::stof(z));
 				} else if (tag[0] == '}') {
 					braces.pop();
 					break;
+				} else if (tag[0] == 'p') {
+					// Object and instance index, the object can come later in the file so it's only checked once everything is in
+					std::string object, instance;
+					*sceneFile >> object >> instance;
+					parent = InstanceRef{ static_cast<uint32_t>(std::stoul(object)), static_cast<uint32_t>(std::stoul(instance)) };
 				} else if (tag[0] == 'v') {
-					*sceneFile >> instance.vertexShaderName;
+					*sceneFile >> vertShader;
 				} else if (tag[0] == 'f') {
-					*sceneFile >> instance.fragmentShaderName;
+					*sceneFile >> fragShader;
 
 				}
 			}
 
-			shaderPair = instance.vertexShaderName + " " + instance.fragmentShaderName;
-			if (!loadedShaderCombinations.contains(shaderPair)) {
-				loadedShaderCombinations[shaderPair] = Shader{ 0, false };
+			uint32_t combination = defaultCombination;
+			if (vertShader != defaultVertShader || fragShader != defaultFragShader) {
+				combination = addShaderCombination(MirielEngine::Utils::GlobalStringInterner->intern(vertShader), MirielEngine::Utils::GlobalStringInterner->intern(fragShader));
 			}
 
-			this->objectInstances[currentObject].push_back(instance);
+			MirielEngine::Utils::DataStructures::SlotHandle instance = this->objectInstances[currentObject].add(combination, translation, rotation, scale);
+			if (!parent.empty()) {
+				unresolvedParents.emplace_back(InstanceHandle{ objectHandle, instance }, parent);
+			}
 		}
 
 	}
 
 	void Scene::loadSceneParticle(std::ifstream* sceneFile) {
-		MirielEngine::Utils::GlobalLogger->log("Loading in Particle Spawners.");
+		MIRIEL_LOG(Debug, Loader, "Loading in Particle Spawners.");
 		std::stack<char> braces{};
 		std::string tag;
 		*sceneFile >> tag;
@@ -208,13 +357,13 @@ namespace MirielEngine::Core {
 				break;
 			}
 
-			ParticleSpawner newParticleSpawner{};
+			ParticleSpawner newParticleSpawner(&arena);
 
 			*sceneFile >> tag;
-			newParticleSpawner.shaders.push_back(tag);
+			newParticleSpawner.shaders.push_back(MirielEngine::Utils::GlobalStringInterner->intern(tag));
 
 			*sceneFile >> tag;
-			newParticleSpawner.shaders.push_back(tag);
+			newParticleSpawner.shaders.push_back(MirielEngine::Utils::GlobalStringInterner->intern(tag));
 
 			newParticleSpawner.position = glm::vec3(0.0, 0.0, 0.0);
 			newParticleSpawner.color = glm::vec3(1.0, 1.0, 1.0);
@@ -238,12 +387,12 @@ namespace MirielEngine::Core {
 				}
 			}
 
-			particles.push_back(newParticleSpawner);
+			particles.insert(std::move(newParticleSpawner));
 		}
 	}
 
 	void Scene::loadSceneCamera(std::ifstream* sceneFile) {
-		MirielEngine::Utils::GlobalLogger->log("Loading in Camera.");
+		MIRIEL_LOG(Debug, Loader, "Loading in Camera.");
 		std::string x, y, z;
 		*sceneFile >> x >> y >> z;
 		camera.pos = glm::vec3(std::stof(x), std::stof(y), std::stof(z));
@@ -256,7 +405,7 @@ namespace MirielEngine::Core {
 	}
 
 	void Scene::loadSceneLight(std::ifstream* sceneFile) {
-		MirielEngine::Utils::GlobalLogger->log("Loading in Lights.");
+		MIRIEL_LOG(Debug, Loader, "Loading in Lights.");
 		std::stack<char> braces{};
 		std::string tag;
 		*sceneFile >> tag;
@@ -300,16 +449,16 @@ namespace MirielEngine::Core {
 			}
 
 			if (newLight.type == 1) {
-				directionalLights.push_back(newLight);
+				directionalLights.insert(newLight);
 			} else {
-				pointLights.push_back(newLight);
+				pointLights.insert(newLight);
 			}
 		}
 	}
 
 	void Scene::loadSceneFile(const std::string& sceneName) {
 		// TODO: If there is a scene already loaded, need to reset the graphics API stuff, like VBO's, programs/ pipelines, etc.
-		MirielEngine::Utils::GlobalLogger->log("Opening Scene File " + sceneName  + ".");
+		MIRIEL_LOG(Info, Loader, "Opening Scene File {}.", sceneName);
 		std::string name = sceneName;
 		scenePath = name;
 		std::ifstream sceneFile(name);
@@ -320,16 +469,55 @@ namespace MirielEngine::Core {
 			throw MirielEngine::Errors::ObjectLoaderError(os.str().c_str());
 		}
 
-		MirielEngine::Utils::GlobalLogger->log(sceneName + " Successfully Opened.");
+		MIRIEL_LOG(Info, Loader, "{} Successfully Opened.", sceneName);
+
+		// First pass only collects the models this scene needs, in the order they first show up
+		std::vector<std::string> modelPaths;
+		std::unordered_map<std::string, size_t> modelIndices;
+		{
+			std::string tag;
+			while (sceneFile >> tag) {
+				if (isModelFile(tag) && !loadedObjectNames.contains(tag) && !modelIndices.contains(tag)) {
+					modelIndices[tag] = modelPaths.size();
+					modelPaths.push_back(tag);
+				}
+			}
+			sceneFile.clear();
+			sceneFile.seekg(0);
+		}
+
+		// Each import gets its own Assimp::Importer inside loadObject, textures are left for the merge below since they need GL
+		MIRIEL_LOG(Info, Loader, "Importing {} Models.", modelPaths.size());
+		// Made with the arena up front so merging them into objects below is just a move
+		std::vector<Object> importedObjects;
+		importedObjects.reserve(modelPaths.size());
+		for (size_t i = 0; i < modelPaths.size(); i++) {
+			importedObjects.emplace_back(&arena);
+		}
+		std::vector<std::exception_ptr> importErrors(modelPaths.size());
+		MirielEngine::Utils::GlobalJobSystem->parallel_for(0, modelPaths.size(), 1, [&](size_t i) {
+			try {
+				MirielEngine::Core::loadObject(modelPaths[i], &importedObjects[i], TextureLoadFunction{});
+			} catch (...) {
+				importErrors[i] = std::current_exception();
+			}
+		});
 
+		for (const std::exception_ptr& error : importErrors) {
+			if (error) { std::rethrow_exception(error); }
+		}
+
+		// Second pass is the usual parse, objects get merged in file order so the scene matches a serial load
 		std::string objName;
+		unresolvedParents.clear();
 
 		while (sceneFile.good() && !sceneFile.eof()) {
 			std::string tag;
 			sceneFile >> tag;
 
-			if (tag.ends_with(".obj") || tag.ends_with(".gltf") || tag.ends_with(".glb")) {
-				loadSceneObject(&sceneFile, tag);
+			if (isModelFile(tag)) {
+				auto imported = modelIndices.find(tag);
+				loadSceneObject(&sceneFile, tag, imported != modelIndices.end() ? &importedObjects[imported->second] : nullptr);
 			} else if (tag == "c") {
 				loadSceneCamera(&sceneFile);
 			} else if (tag == "l") {
@@ -339,163 +527,363 @@ namespace MirielEngine::Core {
 			}
 		}
 
+		// Parents can be further down the file than their children, every index in it is valid now
+		for (const auto& [child, parent] : unresolvedParents) {
+			InstanceHandle parentHandle = getInstanceHandle(parent);
+			if (parentHandle.empty()) {
+				MIRIEL_LOG(Warning, Loader, "Parent Instance {} of Object {} Doesn't Exist, Leaving the Instance Unparented.", parent.instance, parent.object);
+				continue;
+			}
+			setInstanceParent(child, parentHandle);
+		}
+		unresolvedParents.clear();
+
 		// TODO: set textures next?
 
-		MirielEngine::Utils::GlobalLogger->log(sceneName + " Successfully Loaded.");
+		MIRIEL_LOG(Info, Loader, "{} Successfully Loaded.", sceneName);
 
 		sceneFile.close();
 	}
 
-	ObjectInstance::ObjectInstance(const Object& o) {
-		mTranslation = glm::mat4(1.0f);
-		mRotation = glm::mat4(1.0f);
-		mScale = glm::mat4(1.0f);
-		vScale = glm::vec3(1.0f);
-		vRotation = glm::vec3(0.0f);
-		vTranslation = glm::vec3(0.0f);
-		vertexShaderName = o.vertexShaderName;
-		fragmentShaderName = o.fragmentShaderName;
+	void Scene::addPointLight() {
+		pointLights.insert( Light{glm::vec3(0), glm::vec3(0), 0 });
 	}
 
-	ObjectInstance::~ObjectInstance() = default;
-
-	void ObjectInstance::updateRotation() {
-		mRotation = glm::quat(glm::radians(vRotation));
+	void Scene::addDirectionalLight() {
+		directionalLights.insert(Light{ glm::vec3(0), glm::vec3(0), 1 });
 	}
 
-	void ObjectInstance::updateScale() {
-		mScale = glm::scale(glm::mat4(1), vScale);
+	void Scene::removePointLight(MirielEngine::Utils::DataStructures::SlotHandle light) {
+		pointLights.remove(light);
 	}
 
-	void ObjectInstance::updateTranslation() {
-		mTranslation = glm::translate(glm::mat4(1), vTranslation);
+	void Scene::removeDirectionalLight(MirielEngine::Utils::DataStructures::SlotHandle light) {
+		directionalLights.remove(light);
 	}
 
-	void Scene::addPointLight() {
-		pointLights.push_back( Light{glm::vec3(0), glm::vec3(0), 0 });
+	void Scene::removeParticleSpawner(MirielEngine::Utils::DataStructures::SlotHandle spawner) {
+		particles.remove(spawner);
 	}
 
-	void Scene::addDirectionalLight() {
-		directionalLights.push_back(Light{ glm::vec3(0), glm::vec3(0), 1 });
+	uint32_t Scene::addShaderCombination(MirielEngine::Utils::StringID vertexShader, MirielEngine::Utils::StringID fragmentShader) {
+		uint64_t key = (static_cast<uint64_t>(vertexShader) << 32) | fragmentShader;
+		if (const uint32_t* existing = loadedShaderCombinations.find(key)) { return *existing; }
+
+		uint32_t index = static_cast<uint32_t>(shaderCombinations.size());
+		shaderCombinations.push_back(ShaderCombination{ vertexShader, fragmentShader, Shader{ 0, 0, false } });
+		loadedShaderCombinations.insert(key, index);
+		return index;
 	}
 
 	void Scene::addObjectInstance(size_t index) {
-		ObjectInstance i{objects[index]};
-		objectInstances[index].push_back(i);
+		objectInstances[index].add(addShaderCombination(objects[index].vertexShader, objects[index].fragmentShader));
+	}
+
+	void Scene::removeObjectInstance(InstanceHandle instance) {
+		size_t object = objects.indexOf(instance.object);
+		if (object == MirielEngine::Utils::DataStructures::HandleTable::npos || !objectInstances[object].remove(instance.instance)) { return; }
+		// Every node after the removed one would have to shift, the hierarchy is built again instead
+		instanceHierarchyChanged = true;
+	}
+
+	void Scene::removeObject(MirielEngine::Utils::DataStructures::SlotHandle object) {
+		size_t index = objects.indexOf(object);
+		if (index == MirielEngine::Utils::DataStructures::HandleTable::npos) { return; }
+
+		MIRIEL_LOG(Info, Core, "Removing Object {}.", objects[index].getName());
+		if (removeObjectFunction) { removeObjectFunction(index); }
+
+		loadedObjectNames.erase(objects[index].path);
+		objects.remove(object);
+		if (index != objectInstances.size() - 1) { objectInstances[index] = std::move(objectInstances.back()); }
+		objectInstances.pop_back();
+		instanceHierarchyChanged = true;
+	}
 
-		if (i.vertexShaderName.empty() || i.fragmentShaderName.empty()) { return; }
-		i.shaderProgram = loadedShaderCombinations[i.vertexShaderName + " " + i.fragmentShaderName];
+	InstanceRef Scene::findInstance(InstanceHandle instance) const {
+		size_t object = objects.indexOf(instance.object);
+		if (object == MirielEngine::Utils::DataStructures::HandleTable::npos) { return InstanceRef{}; }
+		size_t index = objectInstances[object].indexOf(instance.instance);
+		if (index == MirielEngine::Utils::DataStructures::HandleTable::npos) { return InstanceRef{}; }
+		return InstanceRef{ static_cast<uint32_t>(object), static_cast<uint32_t>(index) };
+	}
+
+	InstanceHandle Scene::getInstanceHandle(InstanceRef instance) const {
+		if (instance.object >= objectInstances.size() || instance.instance >= objectInstances[instance.object].size()) { return InstanceHandle{}; }
+		return InstanceHandle{ objects.handleAt(instance.object), objectInstances[instance.object].handleAt(instance.instance) };
+	}
+
+	bool Scene::setInstanceParent(InstanceHandle child, InstanceHandle parent) {
+		InstanceRef childRef = findInstance(child);
+		if (childRef.empty() || (!parent.empty() && findInstance(parent).empty())) { return false; }
+
+		// Walking up from the new parent has to run out before it gets back to child, bounded in case a loaded file already has a loop
+		size_t steps = 1;
+		for (const InstanceStore& instances : objectInstances) {
+			steps += instances.size();
+		}
+		for (InstanceRef ref = findInstance(parent); !ref.empty() && steps > 0; ref = findInstance(objectInstances[ref.object].parents[ref.instance]), steps--) {
+			if (ref.object == childRef.object && ref.instance == childRef.instance) {
+				MIRIEL_LOG(Warning, Core, "Instance {} of Object {} Can't be Parented to its Own Child.", childRef.instance, childRef.object);
+				return false;
+			}
+		}
+
+		objectInstances[childRef.object].parents[childRef.instance] = parent;
+		instanceHierarchyChanged = true;
+		return true;
+	}
+
+	void Scene::rebuildInstanceHierarchy() {
+		instanceHierarchyChanged = false;
+		instanceHierarchy.clear();
+		instanceHierarchyOwners.clear();
+
+		// Every instance gets a flat index so parents and children can be looked up without hashing
+		std::vector<uint32_t> bases(objectInstances.size());
+		uint32_t instanceCount = 0;
+		for (size_t i = 0; i < objectInstances.size(); i++) {
+			bases[i] = instanceCount;
+			instanceCount += static_cast<uint32_t>(objectInstances[i].size());
+		}
+
+		std::vector<InstanceRef> refs(instanceCount);
+		std::vector<uint32_t> parentOf(instanceCount, TransformHierarchy::NoParent);
+		for (uint32_t object = 0; object < objectInstances.size(); object++) {
+			InstanceStore& instances = objectInstances[object];
+			for (uint32_t instance = 0; instance < instances.size(); instance++) {
+				uint32_t flat = bases[object] + instance;
+				refs[flat] = InstanceRef{ object, instance };
+
+				if (instances.parents[instance].empty()) { continue; }
+				InstanceRef parent = findInstance(instances.parents[instance]);
+				if (!parent.empty()) {
+					parentOf[flat] = bases[parent.object] + parent.instance;
+				} else {
+					// The parent was removed, the child stays where its local transform puts it
+					MIRIEL_LOG(Info, Core, "Instance {} of Object {} Lost its Parent, Detaching it.", instance, object);
+					instances.parents[instance] = InstanceHandle{};
+				}
+			}
+		}
+
+		// Children of each instance packed together, childStarts[i] to childStarts[i + 1]
+		std::vector<uint32_t> childStarts(instanceCount + 1, 0);
+		for (uint32_t i = 0; i < instanceCount; i++) {
+			if (parentOf[i] != TransformHierarchy::NoParent) { childStarts[parentOf[i] + 1]++; }
+		}
+		for (uint32_t i = 0; i < instanceCount; i++) {
+			childStarts[i + 1] += childStarts[i];
+		}
+		std::vector<uint32_t> children(childStarts.back());
+		std::vector<uint32_t> childCursor(childStarts.begin(), childStarts.end() - 1);
+		for (uint32_t i = 0; i < instanceCount; i++) {
+			if (parentOf[i] != TransformHierarchy::NoParent) { children[childCursor[parentOf[i]]++] = i; }
+		}
+
+		std::vector<uint32_t> order;
+		order.reserve(instanceCount);
+		for (uint32_t i = 0; i < instanceCount; i++) {
+			if (parentOf[i] == TransformHierarchy::NoParent) { order.push_back(i); }
+		}
+		for (size_t head = 0; head < order.size(); head++) {
+			for (uint32_t c = childStarts[order[head]]; c < childStarts[order[head] + 1]; c++) {
+				order.push_back(children[c]);
+			}
+		}
+
+		// Anything never reached is in a loop, which only a hand edited file can do
+		if (order.size() < instanceCount) {
+			std::vector<uint8_t> reached(instanceCount, 0);
+			for (uint32_t i : order) { reached[i] = 1; }
+			for (uint32_t i = 0; i < instanceCount; i++) {
+				if (reached[i]) { continue; }
+				MIRIEL_LOG(Warning, Core, "Instance {} of Object {} is Parented in a Loop, Detaching it.", refs[i].instance, refs[i].object);
+				objectInstances[refs[i].object].parents[refs[i].instance] = InstanceHandle{};
+			}
+			rebuildInstanceHierarchy();
+			return;
+		}
+
+		std::vector<uint32_t> nodeOf(instanceCount);
+		instanceHierarchy.reserve(instanceCount);
+		instanceHierarchyOwners.reserve(instanceCount);
+		for (uint32_t i : order) {
+			InstanceStore& instances = objectInstances[refs[i].object];
+			uint32_t parent = parentOf[i] == TransformHierarchy::NoParent ? TransformHierarchy::NoParent : nodeOf[parentOf[i]];
+			nodeOf[i] = instanceHierarchy.add(parent, instances.getLocalMatrix(refs[i].instance));
+			instances.nodes[refs[i].instance] = nodeOf[i];
+			instanceHierarchyOwners.push_back(refs[i]);
+		}
+
+		// Every local was just rebuilt from scratch
+		for (InstanceStore& instances : objectInstances) {
+			instances.clearChanged();
+		}
+	}
+
+	void Scene::updateTransforms() {
+		size_t instanceCount = 0;
+		for (const InstanceStore& instances : objectInstances) {
+			instanceCount += instances.size();
+		}
+
+		if (instanceHierarchyChanged || instanceCount != instanceHierarchy.size()) {
+			rebuildInstanceHierarchy();
+		} else {
+			for (InstanceStore& instances : objectInstances) {
+				if (instances.changed.empty()) { continue; }
+
+				std::pmr::vector<uint32_t>& changed = instances.changed;
+				MirielEngine::Utils::GlobalJobSystem->parallel_for(0, changed.size(), 1024, [this, &instances, &changed](size_t i) {
+					instanceHierarchy.locals[instances.nodes[changed[i]]] = instances.getLocalMatrix(changed[i]);
+				});
+				for (uint32_t instance : changed) {
+					instanceHierarchy.markDirty(instances.nodes[instance]);
+				}
+				instances.clearChanged();
+			}
+		}
+
+		instanceHierarchy.propagate();
+		for (uint32_t node : instanceHierarchy.changed) {
+			const InstanceRef& owner = instanceHierarchyOwners[node];
+			InstanceStore& instances = objectInstances[owner.object];
+			instances.worldMatrices[owner.instance] = instanceHierarchy.worlds[node];
+			// Can already be in there when the renderer skipped a frame, it copes with repeats
+			instances.moved.push_back(owner.instance);
+		}
+
+		for (Object& object : objects) {
+			object.nodes.propagate();
+			if (!object.nodes.changed.empty()) { object.nodesMoved = true; }
+		}
+	}
+
+	void Scene::markAllTransformsDirty() {
+		instanceHierarchy.markAllDirty();
+		for (Object& object : objects) {
+			object.nodesMoved = true;
+		}
 	}
 
 	void Scene::switchVertShader(size_t objectIndex, size_t instanceIndex) {
-		MirielEngine::Utils::GlobalLogger->log("User is Adding New Vertex Shader.");
+		MIRIEL_LOG(Info, GUI, "User is Adding New Vertex Shader.");
 		nfdu8char_t* outPath;
 		nfdu8filteritem_t filters[1] = { {"Vertex Shader File", "vert"} };
 		nfdopendialogu8args_t args = { 0 };
 		args.filterList = filters;
 		args.filterCount = 1;
-		MirielEngine::Utils::GlobalLogger->log("Opening Dialogue Box with NFD.");
+		MIRIEL_LOG(Debug, GUI, "Opening Dialogue Box with NFD.");
 		nfdresult_t res = NFD_OpenDialogU8_With(&outPath, &args);
 
 		if (res != NFD_OKAY) {
 			return;
 		}
 
-		std::ostringstream oss;
-		oss << "User Selected New Item: " << outPath;
-		MirielEngine::Utils::GlobalLogger->log(oss.str());
+		MIRIEL_LOG(Info, GUI, "User Selected New Item: {}", outPath);
 
-		objectInstances[objectIndex][instanceIndex].vertexShaderName = outPath;
+		uint32_t& combination = objectInstances[objectIndex].shaderCombinations[instanceIndex];
+		combination = addShaderCombination(MirielEngine::Utils::GlobalStringInterner->intern(outPath), shaderCombinations[combination].fragmentShader);
 
-		MirielEngine::Utils::GlobalLogger->log("New Vertex Shader Added.");
-
-		if (objectInstances[objectIndex][instanceIndex].fragmentShaderName.empty()) { return; }
-
-		std::string key = objectInstances[objectIndex][instanceIndex].vertexShaderName + " " + objectInstances[objectIndex][instanceIndex].fragmentShaderName;
-
-		if (!loadedShaderCombinations.contains(key)) {
-			loadedShaderCombinations[key] = Shader{0, false};
-		}
+		MIRIEL_LOG(Info, Loader, "New Vertex Shader Added.");
 
 		NFD_FreePathU8(outPath);
 	}
 
 	void Scene::switchFragShader(size_t objectIndex, size_t instanceIndex) {
-		MirielEngine::Utils::GlobalLogger->log("User is Adding New Fragment Shader.");
+		MIRIEL_LOG(Info, GUI, "User is Adding New Fragment Shader.");
 		nfdu8char_t* outPath;
 		nfdu8filteritem_t filters[1] = { {"Fragment Shader File", "frag"} };
 		nfdopendialogu8args_t args = { 0 };
 		args.filterList = filters;
 		args.filterCount = 1;
-		MirielEngine::Utils::GlobalLogger->log("Opening Dialogue Box with NFD.");
+		MIRIEL_LOG(Debug, GUI, "Opening Dialogue Box with NFD.");
 		nfdresult_t res = NFD_OpenDialogU8_With(&outPath, &args);
 
 		if (res != NFD_OKAY) {
 			return;
 		}
 
-		std::ostringstream oss;
-		oss << "User Selected New Item: " << outPath;
-		MirielEngine::Utils::GlobalLogger->log(oss.str());
-
-		objectInstances[objectIndex][instanceIndex].fragmentShaderName = outPath;
+		MIRIEL_LOG(Info, GUI, "User Selected New Item: {}", outPath);
 
-		MirielEngine::Utils::GlobalLogger->log("New Fragment Shader Added.");
+		uint32_t& combination = objectInstances[objectIndex].shaderCombinations[instanceIndex];
+		combination = addShaderCombination(shaderCombinations[combination].vertexShader, MirielEngine::Utils::GlobalStringInterner->intern(outPath));
 
-		if (objectInstances[objectIndex][instanceIndex].vertexShaderName.empty()) { return; }
-
-		std::string key = objectInstances[objectIndex][instanceIndex].vertexShaderName + " " + objectInstances[objectIndex][instanceIndex].fragmentShaderName;
-
-		if (!loadedShaderCombinations.contains(key)) {
-			loadedShaderCombinations[key] = Shader{ 0, false };
-		}
+		MIRIEL_LOG(Info, Loader, "New Fragment Shader Added.");
 
 		NFD_FreePathU8(outPath);
 	}
 
 	void Scene::addObject() {
-		MirielEngine::Utils::GlobalLogger->log("User is Adding New Object.");
+		MIRIEL_LOG(Info, GUI, "User is Adding New Object.");
 		nfdu8char_t* outPath;
 		nfdu8filteritem_t filters[1] = {{"Object Files", "obj,glb,gltf"}};
 		nfdopendialogu8args_t args = {0};
 		args.filterList = filters;
 		args.filterCount = 1;
-		MirielEngine::Utils::GlobalLogger->log("Opening Dialogue Box with NFD.");
+		MIRIEL_LOG(Debug, GUI, "Opening Dialogue Box with NFD.");
 		nfdresult_t res = NFD_OpenDialogU8_With(&outPath, &args);
 
 		if (res != NFD_OKAY) {
 			return;
 		}
 
-		std::ostringstream oss;
-		oss << "User Selected New Item: " << outPath;
-		MirielEngine::Utils::GlobalLogger->log(oss.str());
+		MIRIEL_LOG(Info, GUI, "User Selected New Item: {}", outPath);
 
-		if (loadedObjectNames.contains(outPath)) {
+		if (loadedObjectNames.contains(outPath) || importingObjectNames.contains(outPath)) {
+			NFD_FreePathU8(outPath);
 			return;
 		}
 
-		Object o{};
+		Object o(&arena);
 		o.path = outPath;
 
-		if (!loadedShaderCombinations.empty()) {
-			std::string loadedShader = loadedShaderCombinations.begin()->first;
-			size_t splitIndex = loadedShader.find(' ');
-			o.vertexShaderName = loadedShader.substr(0, splitIndex);
-			o.fragmentShaderName = loadedShader.substr(splitIndex + 1, loadedShader.size() - o.vertexShaderName.size() - 1);
+		if (!shaderCombinations.empty()) {
+			o.vertexShader = shaderCombinations.front().vertexShader;
+			o.fragmentShader = shaderCombinations.front().fragmentShader;
 		}
 
-		MirielEngine::Core::loadObject(outPath, &o, textureLoader);
-		loadedObjectNames[outPath] = objects.size();
-		objects.push_back(o);
+		importingObjectNames.insert(outPath);
+		importObject(outPath, std::move(o)).start(&pendingImports);
 
-		objectInstances[objects.size() - 1] = std::vector<ObjectInstance>{};
+		NFD_FreePathU8(outPath);
+	}
+
+	MirielEngine::Utils::Task Scene::importObject(std::string path, Object object) {
+		// assimp and the mesh processing don't need the main thread, the editor keeps drawing while this runs
+		co_await MirielEngine::Utils::switchToWorkerPool();
+		bool imported = true;
+		try {
+			MirielEngine::Core::loadObject(path, &object, TextureLoadFunction{});
+		} catch (std::exception& e) {
+			// Caught here rather than left to the task so the name below is always released
+			MIRIEL_LOG(Error, Loader, "{}", e.what());
+			imported = false;
+		}
+
+		// Textures and the scene itself belong to the main thread
+		co_await MirielEngine::Utils::switchToMainThread();
+		importingObjectNames.erase(path);
+		if (!imported) { co_return; }
+
+		resolveObjectTextures(&object, textureLoader);
+		loadedObjectNames[path] = objects.insert(std::move(object));
+
+		objectInstances.push_back(InstanceStore(&arena));
 		addObjectInstance(objects.size() - 1);
-		MirielEngine::Utils::GlobalLogger->log("New Object Has Been Added.");
+		MIRIEL_LOG(Info, Loader, "New Object Has Been Added.");
+	}
 
-		NFD_FreePathU8(outPath);
+	void Scene::waitForImports() {
+		MirielEngine::Utils::GlobalJobSystem->wait(pendingImports);
 	}
 
+	Object::Object(std::pmr::memory_resource* resource) : vertices(resource), compactVertices(resource), indices(resource), shortIndices(resource), textures(resource), meshes(resource) {}
+
+	ParticleSpawner::ParticleSpawner(std::pmr::memory_resource* resource)
+		: shaders(resource), particlePositions(resource), particleLifetimes(resource), position(0.0f), color(1.0f) {}
+
 	std::string Object::getName() {
 		size_t i = path.rfind('/');
 		if (i >= path.size()) {
@@ -504,6 +892,13 @@ namespace MirielEngine::Core {
 		return path.substr(i + 1);
 	}
 
+	PositionDequantize Object::getPositionDequantize(const MeshRange& mesh) const {
+		if (vertexLayout == VertexLayout::Full) { return PositionDequantize{ glm::vec4(0.0f), glm::vec4(1.0f) }; }
+
+		// Compact positions come in as 0 to 1 across the mesh's bounds
+		return PositionDequantize{ glm::vec4(mesh.boundsMin, 0.0f), glm::vec4(mesh.boundsMax - mesh.boundsMin, 1.0f) };
+	}
+
 	void Scene::saveScene() {
 		if (scenePath.empty()) {
 			nfdu8char_t* outPath;
@@ -511,56 +906,52 @@ namespace MirielEngine::Core {
 			nfdsavedialogu8args_t args = { 0 };
 			args.filterList = filters;
 			args.filterCount = 1;
-			MirielEngine::Utils::GlobalLogger->log("Opening Dialogue Box with NFD.");
+			MIRIEL_LOG(Debug, GUI, "Opening Dialogue Box with NFD.");
 			nfdresult_t res = NFD_SaveDialogU8_With(&outPath, &args);
 
 			if (res != NFD_OKAY) {
 				return;
 			}
 
-			std::ostringstream oss;
-			oss << "User Has Chosen a New File Name: " << outPath;
-			MirielEngine::Utils::GlobalLogger->log(oss.str());
+			MIRIEL_LOG(Info, GUI, "User Has Chosen a New File Name: {}", outPath);
 
 			scenePath = outPath;
 
 			NFD_FreePathU8(outPath);
 		}
 
-		std::ostringstream oss;
-		oss << "Saving Scene: " << scenePath;
-		MirielEngine::Utils::GlobalLogger->log(oss.str());
+		MIRIEL_LOG(Info, Loader, "Saving Scene: {}", scenePath);
 
 		std::ofstream sceneFile(scenePath, std::ofstream::trunc | std::ofstream::out);
 
-		if (!loadedShaderCombinations.empty()) {
+		if (!shaderCombinations.empty()) {
 
 			for (size_t i = 0; i < objects.size(); i++) {
 				sceneFile << objects[i].path << "\n{\n";
 
-				if (objects[i].vertexShaderName.empty() || objects[i].fragmentShaderName.empty()) {
-					std::string loadedShader = loadedShaderCombinations.begin()->first;
-					size_t splitIndex = loadedShader.find(' ');
-					objects[i].vertexShaderName = loadedShader.substr(0, splitIndex);
-					objects[i].fragmentShaderName = loadedShader.substr(splitIndex + 1, loadedShader.size() - objects[i].vertexShaderName.size() - 1);
+				if (objects[i].vertexShader == MirielEngine::Utils::StringInterner::Empty || objects[i].fragmentShader == MirielEngine::Utils::StringInterner::Empty) {
+					objects[i].vertexShader = shaderCombinations.front().vertexShader;
+					objects[i].fragmentShader = shaderCombinations.front().fragmentShader;
 				}
 
-				sceneFile << "\t" << objects[i].vertexShaderName << " " << objects[i].fragmentShaderName;
+				sceneFile << "\t" << MirielEngine::Utils::GlobalStringInterner->get(objects[i].vertexShader) << " " << MirielEngine::Utils::GlobalStringInterner->get(objects[i].fragmentShader);
 
-				for (size_t j = 0; j < objectInstances[i].size(); j++) {
+				const InstanceStore& instances = objectInstances[i];
+				for (size_t j = 0; j < instances.size(); j++) {
 					sceneFile << "\n\t{";
-					glm::vec3 t = objectInstances[i][j].vTranslation;
-					glm::vec3 r = objectInstances[i][j].vRotation;
-					glm::vec3 s = objectInstances[i][j].vScale;
+					glm::vec3 t = instances.translations[j];
+					glm::vec3 r = instances.rotations[j];
+					glm::vec3 s = instances.scales[j];
+					const ShaderCombination& combination = shaderCombinations[instances.shaderCombinations[j]];
 
 					std::string ex = "\n\t\tf ";
-					if (objectInstances[i][j].vertexShaderName != objects[i].vertexShaderName) {
-						sceneFile << "\n\t\tv " << objectInstances[i][j].vertexShaderName;
+					if (combination.vertexShader != objects[i].vertexShader) {
+						sceneFile << "\n\t\tv " << MirielEngine::Utils::GlobalStringInterner->get(combination.vertexShader);
 						ex = " f ";
 					}
 
-					if (objectInstances[i][j].fragmentShaderName != objects[i].fragmentShaderName) {
-						sceneFile << ex << objectInstances[i][j].fragmentShaderName;
+					if (combination.fragmentShader != objects[i].fragmentShader) {
+						sceneFile << ex << MirielEngine::Utils::GlobalStringInterner->get(combination.fragmentShader);
 					}
 
 					ex = "\t";
@@ -580,6 +971,13 @@ namespace MirielEngine::Core {
 						ex = "\n\t";
 					}
 
+					// Written as indices, which is the order everything is loaded back in
+					InstanceRef parent = findInstance(instances.parents[j]);
+					if (!parent.empty()) {
+						sceneFile << "\n\t\tp " << parent.object << " " << parent.instance;
+						ex = "\n\t";
+					}
+
 					sceneFile << ex << "}\n";
 				}
 				sceneFile << "}\n";
@@ -609,7 +1007,7 @@ namespace MirielEngine::Core {
 		ex = "\t";
 		for (size_t i = 0; i < particles.size(); i++) {
 			sceneFile << "\n\t{\n\t\t";
-			sceneFile << particles[i].shaders[0] << " " << particles[i].shaders[1] << "\n";
+			sceneFile << MirielEngine::Utils::GlobalStringInterner->get(particles[i].shaders[0]) << " " << MirielEngine::Utils::GlobalStringInterner->get(particles[i].shaders[1]) << "\n";
 			sceneFile << "\t\tp " << particles[i].position.x << " " << particles[i].position.y << " " << particles[i].position.z << "\n";
 			sceneFile << "\t\tc " << particles[i].color.x << " " << particles[i].color.y << " " << particles[i].color.z << "\n";
 			sceneFile << "\t}";
@@ -623,22 +1021,20 @@ namespace MirielEngine::Core {
 	}
 
 	void Scene::saveSceneAs() {
-		MirielEngine::Utils::GlobalLogger->log("Saving Scene As...");
+		MIRIEL_LOG(Info, Loader, "Saving Scene As...");
 		nfdu8char_t* outPath;
 		nfdu8filteritem_t filters[1] = { {"Miriel Engine Scene File", "mscn"} };
 		nfdsavedialogu8args_t args = { 0 };
 		args.filterList = filters;
 		args.filterCount = 1;
-		MirielEngine::Utils::GlobalLogger->log("Opening Dialogue Box with NFD.");
+		MIRIEL_LOG(Debug, GUI, "Opening Dialogue Box with NFD.");
 		nfdresult_t res = NFD_SaveDialogU8_With(&outPath, &args);
 
 		if (res != NFD_OKAY) {
 			return;
 		}
 
-		std::ostringstream oss;
-		oss << "User Has Chosen a New File Name: " << outPath;
-		MirielEngine::Utils::GlobalLogger->log(oss.str());
+		MIRIEL_LOG(Info, GUI, "User Has Chosen a New File Name: {}", outPath);
 
 		scenePath = outPath;
 		saveScene();
@@ -649,34 +1045,42 @@ namespace MirielEngine::Core {
 	void Scene::newScene() {
 		// TODO: Needs to reset all buffers and unload everthing that needs to be unloaded.
 		// Can use the open dialogue like in open loader, then call a reset function, then load scene and a build function from parent
+		waitForImports();
 		loadedObjectNames.clear();
 		objectInstances.clear();
+		instanceHierarchy.clear();
+		instanceHierarchyOwners.clear();
+		instanceHierarchyChanged = false;
+		shaderCombinations.clear();
 		objects.clear();
 		loadedShaderCombinations.clear();
 		pointLights.clear();
 		directionalLights.clear();
 		particles.clear();
+		unresolvedParents.clear();
 		scenePath = "";
 		clearAPIFunction();
+
+		// Everything allocated from the arena went with the containers above
+		MIRIEL_LOG(Debug, Core, "Releasing Scene Arena, {} Bytes Used Out of {} Reserved.", arena.getUsedBytes(), arena.getReservedBytes());
+		arena.release();
 	}
 
 	void Scene::loadScene() {
-		MirielEngine::Utils::GlobalLogger->log("User is Loading New Scene.");
+		MIRIEL_LOG(Info, GUI, "User is Loading New Scene.");
 		nfdu8char_t* outPath;
 		nfdu8filteritem_t filters[1] = { {"Miriel Engine Scene File", "mscn"} };
 		nfdopendialogu8args_t args = { 0 };
 		args.filterList = filters;
 		args.filterCount = 1;
-		MirielEngine::Utils::GlobalLogger->log("Opening Dialogue Box with NFD.");
+		MIRIEL_LOG(Debug, GUI, "Opening Dialogue Box with NFD.");
 		nfdresult_t res = NFD_OpenDialogU8_With(&outPath, &args);
 
 		if (res != NFD_OKAY) {
 			return;
 		}
 
-		std::ostringstream oss;
-		oss << "User Selected New Item: " << outPath;
-		MirielEngine::Utils::GlobalLogger->log(oss.str());
+		MIRIEL_LOG(Info, GUI, "User Selected New Item: {}", outPath);
 
 		newScene();
 		loadSceneFile(outPath);
@@ -0,0 +1,101 @@
+#include "Scenes/TransformHierarchy.hpp"
+
+#include <algorithm>
+
+#include "Utils/JobSystem.hpp"
+#include "CustomErrors/MirielEngineErrors.hpp"
+
+namespace MirielEngine::Core {
+	void TransformHierarchy::reserve(size_t count) {
+		parents.reserve(count);
+		depths.reserve(count);
+		locals.reserve(count);
+		worlds.reserve(count);
+		children.reserve(count);
+		dirty.reserve(count);
+	}
+
+	void TransformHierarchy::clear() {
+		parents.clear();
+		depths.clear();
+		locals.clear();
+		worlds.clear();
+		levelStarts.clear();
+		changed.clear();
+		children.clear();
+		dirty.clear();
+		dirtyLevels.clear();
+		firstDirtyLevel = NoLevel;
+	}
+
+	uint32_t TransformHierarchy::add(uint32_t parent, const glm::mat4& local) {
+		uint32_t depth = parent == NoParent ? 0 : depths[parent] + 1;
+		if (!depths.empty() && depth < depths.back()) {
+			throw MirielEngine::Errors::CoreError("Transform Hierarchy Nodes Have to be Added Breadth First.");
+		}
+
+		uint32_t node = static_cast<uint32_t>(parents.size());
+		if (depth == levelStarts.size()) {
+			levelStarts.push_back(node);
+			dirtyLevels.emplace_back();
+		}
+
+		parents.push_back(parent);
+		depths.push_back(depth);
+		locals.push_back(local);
+		worlds.push_back(local);
+		children.emplace_back();
+		if (parent != NoParent) { children[parent].push_back(node); }
+		dirty.push_back(0);
+		markDirty(node);
+		return node;
+	}
+
+	void TransformHierarchy::setLocal(uint32_t node, const glm::mat4& local) {
+		locals[node] = local;
+		markDirty(node);
+	}
+
+	void TransformHierarchy::markDirty(uint32_t node) {
+		if (dirty[node]) { return; }
+		dirty[node] = 1;
+		dirtyLevels[depths[node]].push_back(node);
+		firstDirtyLevel = std::min(firstDirtyLevel, depths[node]);
+	}
+
+	void TransformHierarchy::markAllDirty() {
+		for (uint32_t node = 0; node < size(); node++) {
+			markDirty(node);
+		}
+	}
+
+	void TransformHierarchy::propagate() {
+		changed.clear();
+		// Nothing touched since last time is the usual case and costs nothing
+		if (firstDirtyLevel == NoLevel) { return; }
+
+		for (size_t level = firstDirtyLevel; level < levelStarts.size(); level++) {
+			std::vector<uint32_t>& levelDirty = dirtyLevels[level];
+			if (levelDirty.empty()) { continue; }
+			// Marked in whatever order setLocal was called, sorted they read the level front to back and changed stays breadth first
+			std::sort(levelDirty.begin(), levelDirty.end());
+
+			// Each node only writes itself and reads its parent, which the level before already finished
+			MirielEngine::Utils::GlobalJobSystem->parallel_for(0, levelDirty.size(), 1024, [this, &levelDirty](size_t i) {
+				uint32_t node = levelDirty[i];
+				uint32_t parent = parents[node];
+				worlds[node] = parent == NoParent ? locals[node] : worlds[parent] * locals[node];
+			});
+
+			for (uint32_t node : levelDirty) {
+				dirty[node] = 0;
+				changed.push_back(node);
+				for (uint32_t child : children[node]) {
+					markDirty(child);
+				}
+			}
+			levelDirty.clear();
+		}
+		firstDirtyLevel = NoLevel;
+	}
+}
\ No newline at end of file
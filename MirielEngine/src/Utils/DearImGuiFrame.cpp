@@ -17,13 +17,26 @@
 
 namespace MirielEngine::Utils {
 	GUI::GUI(std::shared_ptr<MirielEngine::Core::Scene> s) : scene(s), io(ImGui::GetIO()) {
-		MirielEngine::Utils::GlobalLogger->log("Creating GUI Helper Class.");
-		currentObject = 0;
-		currentList = 0;
+		MIRIEL_LOG(Info, GUI, "Creating GUI Helper Class.");
+		selection = Selection::None;
+		parentInput[0] = 0;
+		parentInput[1] = 0;
+		frameGraph = nullptr;
 	}
 
 	GUI::~GUI() {
-		MirielEngine::Utils::GlobalLogger->log("Destroying GUI Helper Class.");
+		MIRIEL_LOG(Info, GUI, "Destroying GUI Helper Class.");
+	}
+
+	void GUI::setFrameGraph(const FrameGraph* graph) {
+		frameGraph = graph;
+	}
+
+	void GUI::clearSelection() {
+		selection = Selection::None;
+		selectedLight = MirielEngine::Utils::DataStructures::SlotHandle{};
+		selectedInstance = MirielEngine::Core::InstanceHandle{};
+		selectedName = "";
 	}
 
 	void GUI::generateFrame(const ImGuiImplementationFunction& implFunction) {
@@ -35,9 +48,7 @@ namespace MirielEngine::Utils {
 			ImGui::BeginMainMenuBar();
 			if (ImGui::BeginMenu("File")) {
 				if (ImGui::MenuItem("New Scene")) {
-					currentObject = 0;
-					currentList = 0;
-					selectedName = "";
+					clearSelection();
 					auto sharedScene = scene.lock();
 					sharedScene->newScene();
 				}
@@ -53,14 +64,45 @@ namespace MirielEngine::Utils {
 				}
 
 				if (ImGui::MenuItem("Load Scene")) {
-					currentObject = 0;
-					currentList = 0;
-					selectedName = "";
+					clearSelection();
 					auto sharedScene = scene.lock();
 					sharedScene->loadScene();
 				}
 				ImGui::EndMenu();
 			}
+
+			if (ImGui::BeginMenu("Logging")) {
+				// Only changes the runtime filter, anything compiled out by MIRIEL_LOG_MIN_LEVEL stays out
+				MirielEngine::Utils::LogLevel currentLevel = MirielEngine::Utils::GlobalLogger->getRuntimeLevel();
+				for (size_t i = 0; i < MirielEngine::Utils::logLevelCount; i++) {
+					auto level = static_cast<MirielEngine::Utils::LogLevel>(i);
+					if (ImGui::MenuItem(MirielEngine::Utils::getLogLevelName(level), NULL, level == currentLevel)) {
+						MirielEngine::Utils::GlobalLogger->setRuntimeLevel(level);
+					}
+				}
+
+				ImGui::Separator();
+
+				for (size_t i = 0; i < MirielEngine::Utils::logCategoryCount; i++) {
+					auto category = static_cast<MirielEngine::Utils::LogCategory>(1 << i);
+					bool enabled = MirielEngine::Utils::GlobalLogger->getRuntimeCategoryEnabled(category);
+					if (ImGui::MenuItem(MirielEngine::Utils::getLogCategoryName(category), NULL, enabled)) {
+						MirielEngine::Utils::GlobalLogger->setRuntimeCategoryEnabled(category, !enabled);
+					}
+				}
+
+				ImGui::Separator();
+
+				// What producers do when the logger queue is full
+				MirielEngine::Utils::LogBackpressurePolicy currentPolicy = MirielEngine::Utils::GlobalLogger->getBackpressurePolicy();
+				for (size_t i = 0; i < MirielEngine::Utils::logBackpressurePolicyCount; i++) {
+					auto policy = static_cast<MirielEngine::Utils::LogBackpressurePolicy>(i);
+					if (ImGui::MenuItem(MirielEngine::Utils::getLogBackpressurePolicyName(policy), NULL, policy == currentPolicy)) {
+						MirielEngine::Utils::GlobalLogger->setBackpressurePolicy(policy);
+					}
+				}
+				ImGui::EndMenu();
+			}
 			ImGui::EndMainMenuBar();
 		}
 
@@ -88,8 +130,8 @@ namespace MirielEngine::Utils {
 					oss << "Directional Light " << i;
 					if (ImGui::Button(oss.str().c_str())) {
 						selectedName = oss.str();
-						currentList = 0;
-						currentObject = i;
+						selection = Selection::DirectionalLight;
+						selectedLight = sharedScene->directionalLights.handleAt(i);
 					}
 				}
 				if (ImGui::Button("Add Directional Light")) {
@@ -106,8 +148,8 @@ namespace MirielEngine::Utils {
 					oss << "Point Light " << i;
 					if (ImGui::Button(oss.str().c_str())) {
 						selectedName = oss.str();
-						currentList = 1;
-						currentObject = i;
+						selection = Selection::PointLight;
+						selectedLight = sharedScene->pointLights.handleAt(i);
 					}
 				}
 				if (ImGui::Button("Add Point Light")) {
@@ -117,27 +159,49 @@ namespace MirielEngine::Utils {
 
 			ImGui::Separator();
 
+			// Removing changes loadedObjectNames, so it waits until the loop is done
+			MirielEngine::Utils::DataStructures::SlotHandle removedObject;
 			for (const auto& nameObject : sharedScene->loadedObjectNames) {
-				std::string oName = sharedScene->objects[nameObject.second].getName();
+				size_t objectIndex = sharedScene->objects.indexOf(nameObject.second);
+				std::string oName = sharedScene->objects[objectIndex].getName();
 				if (ImGui::CollapsingHeader(oName.c_str())) {
-					for (size_t i = 0; i < sharedScene->objectInstances[nameObject.second].size(); i++) {
+					const MirielEngine::Core::Object& object = sharedScene->objects[objectIndex];
+					// Cooked objects only have the buffers that were uploaded
+					bool compact = object.vertexLayout == MirielEngine::Core::VertexLayout::Compact;
+					size_t vertexCount = compact ? object.compactVertices.size() : object.vertices.size();
+					size_t vertexBytes = vertexCount * (compact ? sizeof(MirielEngine::Core::CompactVertex) : sizeof(MirielEngine::Core::Vertex));
+					ImGui::Text("%zu Vertices, %.1f KB on the GPU (%.1f KB as full floats)", vertexCount, vertexBytes / 1024.0, vertexCount * sizeof(MirielEngine::Core::Vertex) / 1024.0);
+					bool shortIndices = object.indexType == MirielEngine::Core::IndexType::UInt16;
+					size_t indexCount = shortIndices ? object.shortIndices.size() : object.indices.size();
+					ImGui::Text("%zu Indices, %.1f KB at %d bits", indexCount, indexCount * (shortIndices ? sizeof(uint16_t) : sizeof(unsigned int)) / 1024.0, shortIndices ? 16 : 32);
+
+					const MirielEngine::Core::InstanceStore& instances = sharedScene->objectInstances[objectIndex];
+					for (size_t i = 0; i < instances.size(); i++) {
 						std::ostringstream oss;
 						oss << oName << " Instance " << i;
 						if (ImGui::Button(oss.str().c_str())) {
 							selectedName = oss.str();
-							currentList = nameObject.second + 2;
-							currentObject = i;
+							selection = Selection::Instance;
+							selectedInstance = MirielEngine::Core::InstanceHandle{ nameObject.second, instances.handleAt(i) };
 						}
 					}
 					std::ostringstream oss;
 					oss << "Add " << oName;
 					if (ImGui::Button(oss.str().c_str())) {
 						// need a specific function to add new object for each backend to ensure that the shader/program/pipeline exists for it
-						sharedScene->addObjectInstance(nameObject.second);
+						sharedScene->addObjectInstance(objectIndex);
+					}
+					oss.str("");
+					oss << "Remove " << oName;
+					if (ImGui::Button(oss.str().c_str())) {
+						removedObject = nameObject.second;
 					}
 				}
 				ImGui::Separator();
 			}
+			if (!removedObject.empty()) {
+				sharedScene->removeObject(removedObject);
+			}
 			if (ImGui::Button("Add New Object")) {
 				// want to open windows menu, allow user to choose the object, then save the object path
 				// Need to create custom load object function and add in a new instance without a file*
@@ -153,45 +217,130 @@ namespace MirielEngine::Utils {
 			ImGui::Begin("Selected Item");
 			ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
 
+			// Write and flush time only, so a slow disk shows up here rather than in the frame time
+			MirielEngine::Utils::LoggingStats& logStats = MirielEngine::Utils::GlobalLogger->getStats();
+			ImGui::Text("Log segment %.2f MB at %.1f MB/s (last rotated segment %.1f MB/s)", logStats.segmentBytesWritten.load(std::memory_order_relaxed) / (1024.0 * 1024.0),
+						logStats.segmentMegabytesPerSecond.load(std::memory_order_relaxed), logStats.lastSegmentMegabytesPerSecond.load(std::memory_order_relaxed));
+			ImGui::Text("Log segments rotated %llu, compressed %llu", static_cast<unsigned long long>(logStats.segmentsRotated.load(std::memory_order_relaxed)),
+						static_cast<unsigned long long>(logStats.segmentsCompressed.load(std::memory_order_relaxed)));
+			ImGui::Text("Log messages dropped %llu, blocked %llu", static_cast<unsigned long long>(logStats.messagesDropped.load(std::memory_order_relaxed)),
+						static_cast<unsigned long long>(logStats.messagesBlocked.load(std::memory_order_relaxed)));
+
+			// Timings are from the last finished frame, this runs as one of the stages of the current one
+			if (frameGraph && ImGui::CollapsingHeader("Frame Stages")) {
+				ImGui::Text("Frame %.3f ms", frameGraph->getLastFrameMilliseconds());
+				for (const FrameStage& stage : frameGraph->getStages()) {
+					ImGui::Text("%-20s %-6s %7.3f ms (avg %7.3f ms)", stage.name.c_str(), getStageAffinityName(stage.affinity),
+								stage.lastMilliseconds, stage.averageMilliseconds);
+				}
+			}
+
 			auto sharedScene = scene.lock();
 			if (!sharedScene) {
 				ImGui::End();
 				return;
 			}
 
+			// Scene memory only goes back to the heap on New Scene or Load Scene, peak is the most it has held at once
+			const MirielEngine::Utils::MonotonicArena& arena = sharedScene->arena;
+			ImGui::Text("Scene arena %.2f MB used, %.2f MB reserved (peak %.2f MB)", arena.getUsedBytes() / (1024.0 * 1024.0),
+						arena.getReservedBytes() / (1024.0 * 1024.0), arena.getPeakReservedBytes() / (1024.0 * 1024.0));
+
 			if (selectedName.empty()) {
 				ImGui::End();
 				return;
 			}
 
 			if (ImGui::CollapsingHeader(selectedName.c_str())) {
-				switch (currentList) {
-					case 0:
-						ImGui::ColorPicker3("Color", glm::value_ptr(sharedScene->directionalLights[currentObject].color));
-						ImGui::InputFloat3("Direction", glm::value_ptr(sharedScene->directionalLights[currentObject].value), "%0.01f");
+				switch (selection) {
+					case Selection::DirectionalLight: {
+						MirielEngine::Core::Light* light = sharedScene->directionalLights.get(selectedLight);
+						if (!light) {
+							clearSelection();
+							break;
+						}
+						ImGui::ColorPicker3("Color", glm::value_ptr(light->color));
+						ImGui::InputFloat3("Direction", glm::value_ptr(light->value), "%0.01f");
+						if (ImGui::Button("Remove Light")) {
+							sharedScene->removeDirectionalLight(selectedLight);
+							clearSelection();
+						}
 						break;
-					case 1:
-						ImGui::ColorPicker3("Color", glm::value_ptr(sharedScene->pointLights[currentObject].color));
-						ImGui::InputFloat3("Position", glm::value_ptr(sharedScene->pointLights[currentObject].value), "%0.01f");
+					}
+					case Selection::PointLight: {
+						MirielEngine::Core::Light* light = sharedScene->pointLights.get(selectedLight);
+						if (!light) {
+							clearSelection();
+							break;
+						}
+						ImGui::ColorPicker3("Color", glm::value_ptr(light->color));
+						ImGui::InputFloat3("Position", glm::value_ptr(light->value), "%0.01f");
+						if (ImGui::Button("Remove Light")) {
+							sharedScene->removePointLight(selectedLight);
+							clearSelection();
+						}
 						break;
-					default:
-						ImGui::InputFloat3("Translation", glm::value_ptr(sharedScene->objectInstances[currentList - 2][currentObject].vTranslation), "%0.01f");
-						sharedScene->objectInstances[currentList - 2][currentObject].updateTranslation();
-						ImGui::InputFloat3("Scale", glm::value_ptr(sharedScene->objectInstances[currentList - 2][currentObject].vScale), "%0.01f");
-						sharedScene->objectInstances[currentList - 2][currentObject].updateScale();
-						ImGui::InputFloat3("Rotation", glm::value_ptr(sharedScene->objectInstances[currentList - 2][currentObject].vRotation), "%0.01f");
-						sharedScene->objectInstances[currentList - 2][currentObject].updateRotation();
-
-						ImGui::Text(sharedScene->objectInstances[currentList - 2][currentObject].vertexShaderName.c_str());
+					}
+					case Selection::Instance: {
+						// Gone when it or its whole object has been removed
+						MirielEngine::Core::InstanceRef selected = sharedScene->findInstance(selectedInstance);
+						if (selected.empty()) {
+							clearSelection();
+							break;
+						}
+
+						// Only an actual edit queues the instance, its world matrix is rebuilt and uploaded by the renderer
+						MirielEngine::Core::InstanceStore& instances = sharedScene->objectInstances[selected.object];
+						size_t instance = selected.instance;
+						if (ImGui::InputFloat3("Translation", glm::value_ptr(instances.translations[instance]), "%0.01f")) {
+							instances.markDirty(instance);
+						}
+						if (ImGui::InputFloat3("Scale", glm::value_ptr(instances.scales[instance]), "%0.01f")) {
+							instances.markDirty(instance);
+						}
+						if (ImGui::InputFloat3("Rotation", glm::value_ptr(instances.rotations[instance]), "%0.01f")) {
+							instances.updateRotation(instance);
+							instances.markDirty(instance);
+						}
+
+						MirielEngine::Core::InstanceRef parent = sharedScene->findInstance(instances.parents[instance]);
+						if (parent.empty()) {
+							ImGui::Text("No Parent");
+						} else {
+							ImGui::Text("Parent: %s Instance %u", sharedScene->objects[parent.object].getName().c_str(), parent.instance);
+						}
+						ImGui::InputInt2("Parent Object, Instance", parentInput);
+						if (ImGui::Button("Set Parent")) {
+							MirielEngine::Core::InstanceHandle newParent;
+							if (parentInput[0] >= 0 && parentInput[1] >= 0) {
+								newParent = sharedScene->getInstanceHandle(MirielEngine::Core::InstanceRef{ static_cast<uint32_t>(parentInput[0]), static_cast<uint32_t>(parentInput[1]) });
+							}
+							if (newParent.empty() || !sharedScene->setInstanceParent(selectedInstance, newParent)) {
+								MIRIEL_LOG(Warning, GUI, "Couldn't Parent {} to Object {} Instance {}.", selectedName, parentInput[0], parentInput[1]);
+							}
+						}
+						if (!parent.empty() && ImGui::Button("Clear Parent")) {
+							sharedScene->setInstanceParent(selectedInstance, MirielEngine::Core::InstanceHandle{});
+						}
+
+						ImGui::Text(GlobalStringInterner->get(sharedScene->shaderCombinations[instances.shaderCombinations[instance]].vertexShader).c_str());
 						if (ImGui::Button("Change Vertex Shader")) {
-							sharedScene->switchVertShader(currentList - 2, currentObject);
+							sharedScene->switchVertShader(selected.object, instance);
 						}
 
-						ImGui::Text(sharedScene->objectInstances[currentList - 2][currentObject].fragmentShaderName.c_str());
+						ImGui::Text(GlobalStringInterner->get(sharedScene->shaderCombinations[instances.shaderCombinations[instance]].fragmentShader).c_str());
 						if (ImGui::Button("Change Fragment Shader")) {
-							sharedScene->switchFragShader(currentList - 2, currentObject);
+							sharedScene->switchFragShader(selected.object, instance);
+						}
+
+						if (ImGui::Button("Remove Instance")) {
+							sharedScene->removeObjectInstance(selectedInstance);
+							clearSelection();
 						}
 						break;
+					}
+					case Selection::None:
+						break;
 				}
 			}
 
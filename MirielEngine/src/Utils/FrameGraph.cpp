@@ -0,0 +1,104 @@
+#include "Utils/FrameGraph.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace MirielEngine::Utils {
+	namespace {
+		uint32_t toMask(std::initializer_list<FrameResource> resources) {
+			uint32_t mask = 0;
+			for (FrameResource resource : resources) {
+				mask |= static_cast<uint32_t>(resource);
+			}
+			return mask;
+		}
+
+		double millisecondsSince(std::chrono::steady_clock::time_point start) {
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		/*
+			JobSystem::wait would have the main thread run other jobs while it waits, which mid frame could mean a
+			whole model import or a main thread job writing the scene under a worker stage. Worker stages are the
+			only priority jobs, so the main thread takes any no worker has picked up yet (likely the one it's waiting
+			for, with every worker stuck in an import) and otherwise gives the core up until they finish.
+		*/
+		void waitForStage(const FrameStage& stage) {
+			while (!stage.counter->done()) {
+				if (!GlobalJobSystem->runPriorityJob()) { std::this_thread::yield(); }
+			}
+		}
+
+		// Exponential average, steady enough to read in the editor without hiding a spike for long
+		constexpr double timingSmoothing = 0.05;
+	}
+
+	const char* getStageAffinityName(StageAffinity affinity) {
+		switch (affinity) {
+			using enum StageAffinity;
+			case MainThread: return "Main";
+			case Worker: return "Worker";
+			default: return "Unknown";
+		}
+	}
+
+	FrameGraph::FrameGraph() {
+		lastFrameMilliseconds = 0.0;
+	}
+
+	void FrameGraph::addStage(const std::string& name, std::initializer_list<FrameResource> reads, std::initializer_list<FrameResource> writes,
+							StageAffinity affinity, std::function<void()> work) {
+		FrameStage stage{ name, toMask(reads), toMask(writes), affinity, std::move(work), {}, std::make_unique<JobCounter>(), 0.0, 0.0 };
+
+		for (size_t i = 0; i < stages.size(); i++) {
+			const FrameStage& earlier = stages[i];
+			bool writeAfterAny = (earlier.writes & (stage.reads | stage.writes)) != 0;
+			bool writeAfterRead = (earlier.reads & stage.writes) != 0;
+			if (writeAfterAny || writeAfterRead) {
+				stage.dependencies.push_back(i);
+			}
+		}
+
+		MIRIEL_LOG(Debug, Core, "Frame Stage {} Added on the {} Thread with {} Dependencies.", name, getStageAffinityName(affinity), stage.dependencies.size());
+		stages.push_back(std::move(stage));
+	}
+
+	void FrameGraph::execute() {
+		auto frameStart = std::chrono::steady_clock::now();
+
+		for (FrameStage& stage : stages) {
+			for (size_t dependency : stage.dependencies) {
+				waitForStage(stages[dependency]);
+			}
+
+			if (stage.affinity == StageAffinity::MainThread) {
+				auto start = std::chrono::steady_clock::now();
+				try {
+					stage.work();
+				} catch (...) {
+					// Worker stages still point into stages, they have to finish before this unwinds past whoever owns the graph
+					for (FrameStage& running : stages) {
+						waitForStage(running);
+					}
+					throw;
+				}
+				stage.lastMilliseconds = millisecondsSince(start);
+				continue;
+			}
+
+			// Only this stage writes its own timings and nothing reads them until the whole frame has been waited on
+			GlobalJobSystem->submitPriority([&stage]() {
+				auto start = std::chrono::steady_clock::now();
+				stage.work();
+				stage.lastMilliseconds = millisecondsSince(start);
+			}, stage.counter.get());
+		}
+
+		for (FrameStage& stage : stages) {
+			waitForStage(stage);
+			stage.averageMilliseconds += (stage.lastMilliseconds - stage.averageMilliseconds) * timingSmoothing;
+		}
+
+		lastFrameMilliseconds = millisecondsSince(frameStart);
+	}
+}
\ No newline at end of file
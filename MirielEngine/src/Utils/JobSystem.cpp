@@ -0,0 +1,246 @@
+#include "Utils/JobSystem.hpp"
+
+#include <exception>
+
+namespace MirielEngine::Utils {
+	namespace {
+		// Index of the worker running on this thread, anything else (main thread, logger, ...) is noWorker
+		constexpr size_t noWorker = SIZE_MAX;
+		thread_local size_t currentWorker = noWorker;
+	}
+
+	JobSystem::JobSystem() {
+		running = true;
+		mainThreadID = std::this_thread::get_id();
+
+		size_t workerCount = MIRIEL_JOB_WORKERS;
+		if (workerCount == 0) {
+			unsigned int cores = std::thread::hardware_concurrency();
+			workerCount = cores > 3 ? cores - 2 : 1;
+		}
+
+		for (size_t i = 0; i < workerCount; i++) {
+			queues.push_back(std::make_unique<WorkerQueue>());
+		}
+
+		// Every queue has to exist before the first worker goes looking for something to steal
+		for (size_t i = 0; i < workerCount; i++) {
+			workers.emplace_back(&JobSystem::workerLoop, this, i);
+		}
+
+		MIRIEL_LOG(Info, Core, "Job System Started with {} Workers.", workerCount);
+	}
+
+	JobSystem::~JobSystem() = default;
+
+	JobSystem* JobSystem::getInstance() {
+		if (instance == nullptr) {
+			std::scoped_lock<std::mutex> lock(mtx);
+			if (instance == nullptr) {
+				instance = new JobSystem();
+			}
+		}
+		return instance;
+	}
+
+	void JobSystem::workerLoop(size_t index) {
+		currentWorker = index;
+
+		// Keeps going after cleanup starts until everything already queued has run
+		while (running.load() || queuedJobs.load() > 0) {
+			uint32_t seenEpoch = epoch.load(std::memory_order_seq_cst);
+
+			Job job;
+			if (popPriorityJob(job) || popJob(index, job) || stealJob(index, job)) {
+				runJob(job);
+				continue;
+			}
+
+			sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+			if (queuedJobs.load(std::memory_order_seq_cst) == 0 && running.load()) {
+				epoch.wait(seenEpoch, std::memory_order_acquire);
+			}
+			sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		currentWorker = noWorker;
+	}
+
+	void JobSystem::wake() {
+		// Pairs with the sleepingWorkers increment in workerLoop, either we see the sleeper or it sees queuedJobs
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (sleepingWorkers.load(std::memory_order_relaxed) == 0) { return; }
+		epoch.fetch_add(1, std::memory_order_seq_cst);
+		epoch.notify_one();
+	}
+
+	void JobSystem::pushJob(Job&& job) {
+		// Workers keep what they spawn, it is likely to touch the same data and the back of the deque is the hot end
+		size_t index = currentWorker != noWorker ? currentWorker : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+		{
+			std::scoped_lock<std::mutex> lock(queues[index]->mtx);
+			queues[index]->jobs.push_back(std::move(job));
+		}
+		queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+		wake();
+	}
+
+	bool JobSystem::popJob(size_t index, Job& out) {
+		WorkerQueue& queue = *queues[index];
+		std::scoped_lock<std::mutex> lock(queue.mtx);
+		if (queue.jobs.empty()) { return false; }
+		out = std::move(queue.jobs.back());
+		queue.jobs.pop_back();
+		queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	bool JobSystem::popPriorityJob(Job& out) {
+		std::scoped_lock<std::mutex> lock(priorityMtx);
+		if (priorityJobs.empty()) { return false; }
+		out = std::move(priorityJobs.front());
+		priorityJobs.pop_front();
+		queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	bool JobSystem::stealJob(size_t thief, Job& out) {
+		size_t count = queues.size();
+		size_t start = thief != noWorker ? thief + 1 : nextQueue.load(std::memory_order_relaxed);
+		for (size_t i = 0; i < count; i++) {
+			size_t victim = (start + i) % count;
+			if (victim == thief) { continue; }
+
+			WorkerQueue& queue = *queues[victim];
+			std::scoped_lock<std::mutex> lock(queue.mtx);
+			if (queue.jobs.empty()) { continue; }
+			out = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+			queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+		return false;
+	}
+
+	bool JobSystem::tryRunOne() {
+		Job job;
+		if (popPriorityJob(job) || (currentWorker != noWorker && popJob(currentWorker, job)) || stealJob(currentWorker, job)) {
+			runJob(job);
+			return true;
+		}
+		return false;
+	}
+
+	void JobSystem::runJob(Job& job) {
+		// A job that throws still has to count as finished or whoever waits on its counter never wakes up
+		try {
+			job.task();
+		} catch (std::exception& e) {
+			MIRIEL_LOG(Error, Core, "Job Threw an Exception: {}", e.what());
+		} catch (...) {
+			MIRIEL_LOG(Error, Core, "Job Threw an Unknown Exception");
+		}
+		finishJob(job.counter);
+	}
+
+	void JobSystem::finishJob(JobCounter* counter) {
+		if (!counter) { return; }
+
+		std::vector<Job> ready;
+		{
+			// Decrementing under the lock means then() either sees zero or its continuation is in the list we take
+			std::scoped_lock<std::mutex> lock(counter->continuationMtx);
+			if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				ready.swap(counter->continuations);
+			}
+		}
+
+		for (Job& job : ready) {
+			pushJob(std::move(job));
+		}
+	}
+
+	void JobSystem::submit(std::function<void()> task, JobCounter* counter) {
+		if (counter) { counter->pending.fetch_add(1, std::memory_order_relaxed); }
+		pushJob(Job{ std::move(task), counter });
+	}
+
+	void JobSystem::submitPriority(std::function<void()> task, JobCounter* counter) {
+		if (counter) { counter->pending.fetch_add(1, std::memory_order_relaxed); }
+		{
+			std::scoped_lock<std::mutex> lock(priorityMtx);
+			priorityJobs.push_back(Job{ std::move(task), counter });
+		}
+		queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+		wake();
+	}
+
+	bool JobSystem::runPriorityJob() {
+		Job job;
+		if (!popPriorityJob(job)) { return false; }
+		runJob(job);
+		return true;
+	}
+
+	void JobSystem::then(JobCounter& counter, std::function<void()> task, JobCounter* taskCounter) {
+		// Counted now so waiting on taskCounter also covers a continuation that hasn't been submitted yet
+		if (taskCounter) { taskCounter->pending.fetch_add(1, std::memory_order_relaxed); }
+
+		{
+			std::scoped_lock<std::mutex> lock(counter.continuationMtx);
+			if (counter.pending.load(std::memory_order_acquire) != 0) {
+				counter.continuations.push_back(Job{ std::move(task), taskCounter });
+				return;
+			}
+		}
+		pushJob(Job{ std::move(task), taskCounter });
+	}
+
+	void JobSystem::wait(JobCounter& counter) {
+		while (!counter.done()) {
+			if (isMainThread() && pumpMainThread() > 0) { continue; }
+			if (!tryRunOne()) { std::this_thread::yield(); }
+		}
+
+		// The last job may still be inside finishJob holding the lock, the counter can't be destroyed until it lets go
+		std::scoped_lock<std::mutex> lock(counter.continuationMtx);
+	}
+
+	void JobSystem::runOnMainThread(std::function<void()> task, JobCounter* counter) {
+		if (counter) { counter->pending.fetch_add(1, std::memory_order_relaxed); }
+		mainThreadJobs.push(Job{ std::move(task), counter });
+	}
+
+	size_t JobSystem::pumpMainThread() {
+		std::vector<Job> jobs;
+		mainThreadJobs.drain_into(jobs);
+		for (Job& job : jobs) {
+			runJob(job);
+		}
+		return jobs.size();
+	}
+
+	void JobSystem::retainCounter(JobCounter& counter) {
+		counter.pending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void JobSystem::releaseCounter(JobCounter& counter) {
+		finishJob(&counter);
+	}
+
+	void JobSystem::cleanup() {
+		running = false;
+		epoch.fetch_add(1, std::memory_order_seq_cst);
+		epoch.notify_all();
+
+		for (auto& worker : workers) {
+			if (worker.joinable()) { worker.join(); }
+		}
+
+		// Nothing else will pump it once the main loop is gone
+		if (isMainThread()) {
+			while (pumpMainThread() > 0) {}
+		}
+		MIRIEL_LOG(Info, Core, "Job System Stopped.");
+	}
+}
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include "Utils/LogCompressor.hpp"
+
+#include <cstring>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <filesystem>
+
+namespace MirielEngine::Utils {
+	namespace {
+		constexpr size_t minMatch = 4;
+		constexpr size_t maxOffset = 65535;
+		constexpr size_t hashBits = 14;
+		// The last few bytes of a block are always literals, so the matcher never reads past the end
+		constexpr size_t blockTail = 8;
+
+		uint32_t hashBytes(const char* p) {
+			uint32_t v;
+			std::memcpy(&v, p, sizeof(v));
+			return (v * 2654435761u) >> (32 - hashBits);
+		}
+
+		template <typename T>
+		void appendValue(std::string& out, T value) {
+			out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+		}
+
+		template <typename T>
+		bool readValue(std::string_view& in, T& value) {
+			if (in.size() < sizeof(T)) { return false; }
+			std::memcpy(&value, in.data(), sizeof(T));
+			in.remove_prefix(sizeof(T));
+			return true;
+		}
+
+		void appendLength(std::string& out, size_t length) {
+			while (length >= 255) {
+				out.push_back(static_cast<char>(255));
+				length -= 255;
+			}
+			out.push_back(static_cast<char>(length));
+		}
+
+		bool readLength(std::string_view& in, size_t& length) {
+			uint8_t byte;
+			do {
+				if (!readValue(in, byte)) { return false; }
+				length += byte;
+			} while (byte == 255);
+			return true;
+		}
+
+		void appendSequence(std::string& out, const char* literals, size_t literalCount, size_t matchLength, size_t offset) {
+			size_t matchCode = matchLength >= minMatch ? matchLength - minMatch : 0;
+			uint8_t token = static_cast<uint8_t>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15));
+			out.push_back(static_cast<char>(token));
+			if (literalCount >= 15) { appendLength(out, literalCount - 15); }
+			out.append(literals, literalCount);
+
+			if (matchLength == 0) { return; }
+			appendValue(out, static_cast<uint16_t>(offset));
+			if (matchCode >= 15) { appendLength(out, matchCode - 15); }
+		}
+
+		void compressBlock(std::string& out, const char* block, size_t size, std::vector<uint32_t>& table) {
+			std::fill(table.begin(), table.end(), UINT32_MAX);
+
+			size_t anchor = 0;
+			size_t pos = 0;
+			size_t limit = size > blockTail ? size - blockTail : 0;
+
+			while (pos < limit) {
+				uint32_t& entry = table[hashBytes(block + pos)];
+				size_t candidate = entry;
+				entry = static_cast<uint32_t>(pos);
+
+				if (candidate == UINT32_MAX || pos - candidate > maxOffset || std::memcmp(block + candidate, block + pos, minMatch) != 0) {
+					pos++;
+					continue;
+				}
+
+				size_t length = minMatch;
+				while (pos + length < limit && block[candidate + length] == block[pos + length]) { length++; }
+
+				appendSequence(out, block + anchor, pos - anchor, length, pos - candidate);
+				pos += length;
+				anchor = pos;
+			}
+
+			appendSequence(out, block + anchor, size - anchor, 0, 0);
+		}
+
+		bool decompressBlock(std::string_view in, size_t rawSize, std::string& out) {
+			size_t start = out.size();
+			while (!in.empty()) {
+				uint8_t token;
+				readValue(in, token);
+
+				size_t literalCount = token >> 4;
+				if (literalCount == 15 && !readLength(in, literalCount)) { return false; }
+				if (in.size() < literalCount) { return false; }
+				out.append(in.data(), literalCount);
+				in.remove_prefix(literalCount);
+
+				if (in.empty()) { break; }
+
+				uint16_t offset;
+				if (!readValue(in, offset) || offset == 0 || offset > out.size() - start) { return false; }
+				size_t matchLength = token & 15;
+				if (matchLength == 15 && !readLength(in, matchLength)) { return false; }
+				matchLength += minMatch;
+				if (out.size() - start + matchLength > rawSize) { return false; }
+
+				// Matches may overlap what they are copying, so this has to go a byte at a time
+				size_t from = out.size() - offset;
+				for (size_t i = 0; i < matchLength; i++) {
+					out.push_back(out[from + i]);
+				}
+			}
+			return out.size() - start == rawSize;
+		}
+	}
+
+	std::string compressLogData(std::string_view input) {
+		std::string out;
+		out.reserve(input.size() / 2 + 64);
+		out.append(compressedLogMagic, sizeof(compressedLogMagic));
+		appendValue(out, static_cast<uint64_t>(input.size()));
+
+		std::vector<uint32_t> table(size_t(1) << hashBits);
+		for (size_t offset = 0; offset < input.size(); offset += compressionBlockSize) {
+			size_t rawSize = std::min(compressionBlockSize, input.size() - offset);
+			size_t sizeOffset = out.size();
+			appendValue(out, static_cast<uint32_t>(rawSize));
+			appendValue(out, uint32_t(0));
+
+			size_t blockStart = out.size();
+			compressBlock(out, input.data() + offset, rawSize, table);
+			uint32_t compressedSize = static_cast<uint32_t>(out.size() - blockStart);
+			std::memcpy(out.data() + sizeOffset + sizeof(uint32_t), &compressedSize, sizeof(compressedSize));
+		}
+		return out;
+	}
+
+	bool decompressLogData(std::string_view input, std::string& out) {
+		if (input.size() < sizeof(compressedLogMagic) || std::memcmp(input.data(), compressedLogMagic, sizeof(compressedLogMagic)) != 0) { return false; }
+		input.remove_prefix(sizeof(compressedLogMagic));
+
+		uint64_t totalSize;
+		if (!readValue(input, totalSize)) { return false; }
+		out.reserve(out.size() + static_cast<size_t>(std::min<uint64_t>(totalSize, input.size() * 16)));
+
+		uint64_t decoded = 0;
+		while (!input.empty()) {
+			uint32_t rawSize, compressedSize;
+			if (!readValue(input, rawSize) || !readValue(input, compressedSize) || input.size() < compressedSize) { return false; }
+			if (!decompressBlock(input.substr(0, compressedSize), rawSize, out)) { return false; }
+			input.remove_prefix(compressedSize);
+			decoded += rawSize;
+		}
+		return decoded == totalSize;
+	}
+
+	uint64_t compressLogFile(const std::string& inputName) {
+		std::ifstream input(inputName, std::ios::in | std::ios::binary);
+		if (!input.is_open()) { return 0; }
+		std::string contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+		input.close();
+
+		std::string compressed = compressLogData(contents);
+
+		// Written under a temporary name so a half written file never looks like a finished segment
+		std::string outputName = inputName + compressedLogExtension;
+		std::string partialName = outputName + ".part";
+		{
+			std::ofstream output(partialName, std::ios::out | std::ios::trunc | std::ios::binary);
+			output.write(compressed.data(), compressed.size());
+			if (!output.good()) { return 0; }
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(partialName, outputName, ec);
+		if (ec) { return 0; }
+		std::filesystem::remove(inputName, ec);
+		return compressed.size();
+	}
+
+	bool decompressLogFile(const std::string& inputName, const std::string& outputName) {
+		std::ifstream input(inputName, std::ios::in | std::ios::binary);
+		if (!input.is_open()) { return false; }
+		std::string contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+		std::string text;
+		bool complete = decompressLogData(contents, text);
+		if (text.empty()) { return false; }
+
+		std::ofstream output(outputName, std::ios::out | std::ios::trunc | std::ios::binary);
+		output.write(text.data(), text.size());
+		return complete;
+	}
+}
\ No newline at end of file
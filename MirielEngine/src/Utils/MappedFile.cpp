@@ -0,0 +1,157 @@
+#include "Utils/MappedFile.hpp"
+
+#if _WIN64
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace MirielEngine::Utils {
+	MappedFile::~MappedFile() {
+		close();
+	}
+
+#if _WIN64
+	bool MappedFile::openReadWrite(const std::string& path, size_t fileSize) {
+		close();
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) { return false; }
+
+		LARGE_INTEGER mappingSize;
+		mappingSize.QuadPart = static_cast<LONGLONG>(fileSize);
+		if (!SetFilePointerEx(file, mappingSize, NULL, FILE_BEGIN) || !SetEndOfFile(file)) {
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, mappingSize.HighPart, mappingSize.LowPart, NULL);
+		if (mapping == NULL) {
+			CloseHandle(file);
+			return false;
+		}
+
+		void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, fileSize);
+		if (view == NULL) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		fileHandle = file;
+		mappingHandle = mapping;
+		data = view;
+		size = fileSize;
+		writable = true;
+		return true;
+	}
+
+	bool MappedFile::openReadOnly(const std::string& path) {
+		close();
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) { return false; }
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL) {
+			CloseHandle(file);
+			return false;
+		}
+
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (view == NULL) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		fileHandle = file;
+		mappingHandle = mapping;
+		data = view;
+		size = static_cast<size_t>(fileSize.QuadPart);
+		writable = false;
+		return true;
+	}
+
+	void MappedFile::flushAsync() {
+		if (data && writable) { FlushViewOfFile(data, 0); }
+	}
+
+	void MappedFile::close() {
+		if (data) { UnmapViewOfFile(data); }
+		if (mappingHandle) { CloseHandle(mappingHandle); }
+		if (fileHandle) { CloseHandle(fileHandle); }
+		data = nullptr;
+		mappingHandle = nullptr;
+		fileHandle = nullptr;
+		size = 0;
+	}
+#else
+	bool MappedFile::openReadWrite(const std::string& path, size_t fileSize) {
+		close();
+		int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+		if (fd < 0) { return false; }
+
+		if (ftruncate(fd, static_cast<off_t>(fileSize)) != 0) {
+			::close(fd);
+			return false;
+		}
+
+		void* view = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (view == MAP_FAILED) {
+			::close(fd);
+			return false;
+		}
+
+		fileDescriptor = fd;
+		data = view;
+		size = fileSize;
+		writable = true;
+		return true;
+	}
+
+	bool MappedFile::openReadOnly(const std::string& path) {
+		close();
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) { return false; }
+
+		struct stat info;
+		if (fstat(fd, &info) != 0 || info.st_size == 0) {
+			::close(fd);
+			return false;
+		}
+
+		void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+		if (view == MAP_FAILED) {
+			::close(fd);
+			return false;
+		}
+
+		fileDescriptor = fd;
+		data = view;
+		size = static_cast<size_t>(info.st_size);
+		writable = false;
+		return true;
+	}
+
+	void MappedFile::flushAsync() {
+		if (data && writable) { msync(data, size, MS_ASYNC); }
+	}
+
+	void MappedFile::close() {
+		if (data) { munmap(data, size); }
+		if (fileDescriptor >= 0) { ::close(fileDescriptor); }
+		data = nullptr;
+		fileDescriptor = -1;
+		size = 0;
+	}
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "Utils/MappedLogRing.hpp"
+
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+
+namespace MirielEngine::Utils {
+	namespace {
+		constexpr char ringMagic[4] = { 'M', 'R', 'N', 'G' };
+
+		struct FormatEntry {
+			uint16_t id;
+			uint16_t length;
+		};
+	}
+
+	bool MappedLogRing::create(const std::string& path) {
+		close();
+		if (!file.openReadWrite(path, fileSize)) { return false; }
+
+		char* base = static_cast<char*>(file.getData());
+		std::memset(base, 0, fileSize);
+
+		header = reinterpret_cast<Header*>(base);
+		formatTable = base + sizeof(Header);
+		slots = formatTable + formatTableSize;
+
+		header->version = version;
+		header->slotSize = slotSize;
+		header->slotCount = slotCount;
+		header->formatTableSize = formatTableSize;
+		header->tail = 0;
+		header->formatTableUsed = 0;
+		// Magic goes in last so a half initialized file is never mistaken for a ring
+		std::atomic_thread_fence(std::memory_order_release);
+		std::memcpy(header->magic, ringMagic, sizeof(ringMagic));
+
+		for (auto& persisted : formatPersisted) {
+			persisted.store(0, std::memory_order_relaxed);
+		}
+		return true;
+	}
+
+	void MappedLogRing::close() {
+		file.close();
+		header = nullptr;
+		formatTable = nullptr;
+		slots = nullptr;
+	}
+
+	void MappedLogRing::persistFormat(uint16_t formatID) {
+		std::scoped_lock<std::mutex> lock(formatMtx);
+		uint64_t bit = uint64_t(1) << (formatID % 64);
+		if ((formatPersisted[formatID / 64].load(std::memory_order_relaxed) & bit) != 0) { return; }
+
+		std::string_view fmt = LogFormatRegistry::getFormat(formatID);
+		FormatEntry entry{ formatID, static_cast<uint16_t>(std::min<size_t>(fmt.size(), UINT16_MAX)) };
+		size_t entrySize = sizeof(FormatEntry) + entry.length;
+
+		// A full table only costs readable messages after a crash, the records themselves still go in
+		if (header->formatTableUsed + entrySize <= formatTableSize) {
+			char* out = formatTable + header->formatTableUsed;
+			std::memcpy(out, &entry, sizeof(entry));
+			std::memcpy(out + sizeof(entry), fmt.data(), entry.length);
+			std::atomic_thread_fence(std::memory_order_release);
+			header->formatTableUsed += entrySize;
+		}
+
+		formatPersisted[formatID / 64].fetch_or(bit, std::memory_order_release);
+	}
+
+	MappedLogRing::Slot* MappedLogRing::claim(uint64_t& position) {
+		position = std::atomic_ref<uint64_t>(header->tail).fetch_add(1, std::memory_order_relaxed);
+		Slot* slot = reinterpret_cast<Slot*>(slots + (position % slotCount) * slotSize);
+		std::atomic_ref<uint64_t> sequence(slot->sequence);
+
+		// A writer a whole lap behind might still be filling this slot, only take it over once that record is committed
+		uint64_t previous = position >= slotCount ? position + 1 - slotCount : 0;
+		while (sequence.load(std::memory_order_acquire) != previous) {
+			std::this_thread::yield();
+		}
+
+		// Marks the slot as in progress before any field changes, recovery skips it if we die half way
+		sequence.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		return slot;
+	}
+
+	bool MappedLogRing::recover(const std::string& ringPath, const std::string& outputName) {
+		MappedFile ring;
+		if (!ring.openReadOnly(ringPath) || ring.getSize() < sizeof(Header)) { return false; }
+
+		const char* base = static_cast<const char*>(ring.getData());
+		const Header* ringHeader = reinterpret_cast<const Header*>(base);
+
+		if (std::memcmp(ringHeader->magic, ringMagic, sizeof(ringMagic)) != 0 || ringHeader->version != version) { return false; }
+		if (ringHeader->slotSize < sizeof(Slot) || ring.getSize() < sizeof(Header) + ringHeader->formatTableSize + ringHeader->slotSize * ringHeader->slotCount) { return false; }
+
+		std::vector<std::string> formats(LogFormatRegistry::maxFormats, "{}");
+		const char* table = base + sizeof(Header);
+		size_t used = std::min<size_t>(ringHeader->formatTableUsed, ringHeader->formatTableSize);
+		for (size_t offset = 0; offset + sizeof(FormatEntry) <= used;) {
+			FormatEntry entry;
+			std::memcpy(&entry, table + offset, sizeof(entry));
+			offset += sizeof(entry);
+			if (offset + entry.length > used || entry.id >= formats.size()) { break; }
+			formats[entry.id].assign(table + offset, entry.length);
+			offset += entry.length;
+		}
+
+		// Only slots whose sequence matches their position hold a complete record
+		const char* ringSlots = table + ringHeader->formatTableSize;
+		std::vector<const Slot*> records;
+		for (uint64_t i = 0; i < ringHeader->slotCount; i++) {
+			const Slot* slot = reinterpret_cast<const Slot*>(ringSlots + i * ringHeader->slotSize);
+			if (slot->sequence == 0 || (slot->sequence - 1) % ringHeader->slotCount != i) { continue; }
+			records.push_back(slot);
+		}
+
+		if (records.empty()) { return false; }
+
+		std::sort(records.begin(), records.end(), [](const Slot* a, const Slot* b) { return a->sequence < b->sequence; });
+
+		std::string text;
+		LogTimestampFormatter timestamp;
+
+		// Everything claimed before the last lap is gone, say so rather than let the log look complete
+		uint64_t tail = ringHeader->tail;
+		uint64_t overwritten = tail > ringHeader->slotCount ? tail - ringHeader->slotCount : 0;
+		if (overwritten > 0) {
+			std::string args(encodedArgumentSize(overwritten), '\0');
+			encodeArgument(args.data(), overwritten);
+			appendLogLine(text, timestamp, records.front()->time, LogLevel::Warning, LogCategory::Core, "Mapped Log Ring Overwrote {} Earlier Records.", args);
+		}
+
+		size_t maxPayload = ringHeader->slotSize - sizeof(Slot);
+		for (const Slot* slot : records) {
+			std::string_view args(reinterpret_cast<const char*>(slot + 1), std::min<size_t>(slot->length, maxPayload));
+			std::string_view fmt = slot->formatID < formats.size() ? std::string_view(formats[slot->formatID]) : std::string_view("{}");
+			appendLogLine(text, timestamp, slot->time, static_cast<LogLevel>(slot->level), static_cast<LogCategory>(slot->category), fmt, args);
+		}
+
+		std::ofstream output(outputName, std::ios::out | std::ios::app | std::ios::binary);
+		output.write(text.data(), text.size());
+		return true;
+	}
+}
\ No newline at end of file
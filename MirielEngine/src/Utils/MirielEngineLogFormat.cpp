@@ -0,0 +1,209 @@
+#include "Utils/MirielEngineLogFormat.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <ctime>
+#include <cstdio>
+#include <chrono>
+#include <vector>
+#include <fstream>
+
+namespace MirielEngine::Utils {
+	namespace {
+		std::mutex registryMtx;
+		const char* registeredFormats[LogFormatRegistry::maxFormats] = { "{}" };
+		std::atomic<uint16_t> registeredCount{ 1 };
+
+		template <typename T>
+		bool readValue(std::string_view& in, T& value) {
+			if (in.size() < sizeof(T)) { return false; }
+			std::memcpy(&value, in.data(), sizeof(T));
+			in.remove_prefix(sizeof(T));
+			return true;
+		}
+
+		// Appends one decoded argument, returns false once the arguments run out
+		bool appendArgument(std::string& out, std::string_view& args) {
+			uint8_t tag;
+			if (!readValue(args, tag)) { return false; }
+
+			switch (static_cast<LogArgumentType>(tag)) {
+				using enum LogArgumentType;
+				case String: {
+					uint32_t length;
+					if (!readValue(args, length) || args.size() < length) { return false; }
+					out.append(args.data(), length);
+					args.remove_prefix(length);
+					return true;
+				}
+				case Bool: {
+					char v;
+					if (!readValue(args, v)) { return false; }
+					out.append(v ? "true" : "false");
+					return true;
+				}
+				case Char: {
+					char v;
+					if (!readValue(args, v)) { return false; }
+					out.push_back(v);
+					return true;
+				}
+				case Float: {
+					double v;
+					if (!readValue(args, v)) { return false; }
+					char buffer[32];
+					int n = std::snprintf(buffer, sizeof(buffer), "%g", v);
+					out.append(buffer, n);
+					return true;
+				}
+				case SignedInt: {
+					int64_t v;
+					if (!readValue(args, v)) { return false; }
+					out.append(std::to_string(v));
+					return true;
+				}
+				case UnsignedInt: {
+					uint64_t v;
+					if (!readValue(args, v)) { return false; }
+					out.append(std::to_string(v));
+					return true;
+				}
+				default:
+					return false;
+			}
+		}
+	}
+
+	const char* getLogLevelName(LogLevel level) {
+		switch (level) {
+			using enum LogLevel;
+			case Trace: return "Trace";
+			case Debug: return "Debug";
+			case Info: return "Info";
+			case Warning: return "Warning";
+			case Error: return "Error";
+			case Fatal: return "Fatal";
+			default: return "Unknown";
+		}
+	}
+
+	const char* getLogCategoryName(LogCategory category) {
+		switch (category) {
+			using enum LogCategory;
+			case Core: return "Core";
+			case Loader: return "Loader";
+			case OpenGL: return "OpenGL";
+			case GUI: return "GUI";
+			default: return "Unknown";
+		}
+	}
+
+	uint16_t LogFormatRegistry::registerFormat(const char* fmt) {
+		std::scoped_lock<std::mutex> lock(registryMtx);
+		uint16_t id = registeredCount.load(std::memory_order_relaxed);
+		if (id >= maxFormats) {
+			// Out of IDs, fall back to printing the raw format string
+			return plainMessageID;
+		}
+		registeredFormats[id] = fmt;
+		registeredCount.store(id + 1, std::memory_order_release);
+		return id;
+	}
+
+	std::string_view LogFormatRegistry::getFormat(uint16_t id) {
+		if (id >= registeredCount.load(std::memory_order_acquire)) { return "{}"; }
+		return registeredFormats[id];
+	}
+
+	uint16_t LogFormatRegistry::count() {
+		return registeredCount.load(std::memory_order_acquire);
+	}
+
+	void appendFormattedMessage(std::string& out, std::string_view fmt, std::string_view encodedArgs) {
+		size_t pos = 0;
+		while (pos < fmt.size()) {
+			size_t next = fmt.find("{}", pos);
+			if (next == std::string_view::npos) {
+				out.append(fmt.substr(pos));
+				return;
+			}
+
+			out.append(fmt.substr(pos, next - pos));
+			if (!appendArgument(out, encodedArgs)) {
+				out.append("{}");
+			}
+			pos = next + 2;
+		}
+	}
+
+	void LogTimestampFormatter::append(std::string& out, int64_t timeNanoseconds) {
+		int64_t second = timeNanoseconds / 1000000000;
+		if (second != cachedSecond) {
+			std::time_t currTime = static_cast<std::time_t>(second);
+			tm convertedCurrTime;
+			localtime_s(&convertedCurrTime, &currTime);
+			cachedPrefixLength = std::strftime(cachedPrefix, sizeof(cachedPrefix), "%H:%M:%S: ", &convertedCurrTime);
+			cachedSecond = second;
+		}
+		out.append(cachedPrefix, cachedPrefixLength);
+	}
+
+	void appendLogLine(std::string& out, LogTimestampFormatter& timestamp, int64_t timeNanoseconds, LogLevel level, LogCategory category,
+						std::string_view fmt, std::string_view encodedArgs) {
+		timestamp.append(out, timeNanoseconds);
+		if (level != LogLevel::Info) {
+			out.push_back('[');
+			out.append(getLogLevelName(level));
+			out.append("] [");
+			out.append(getLogCategoryName(category));
+			out.append("] ");
+		}
+		appendFormattedMessage(out, fmt, encodedArgs);
+		out.push_back('\n');
+	}
+
+	bool decodeBinaryLog(const std::string& inputName, const std::string& outputName) {
+		std::ifstream input(inputName, std::ios::in | std::ios::binary);
+		if (!input.is_open()) { return false; }
+
+		std::vector<char> contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+		std::string_view data(contents.data(), contents.size());
+
+		uint32_t version;
+		if (data.size() < sizeof(binaryLogMagic) || std::memcmp(data.data(), binaryLogMagic, sizeof(binaryLogMagic)) != 0) { return false; }
+		data.remove_prefix(sizeof(binaryLogMagic));
+		if (!readValue(data, version) || version != binaryLogVersion) { return false; }
+
+		std::vector<std::string> formats(LogFormatRegistry::maxFormats, "{}");
+		LogTimestampFormatter timestamp;
+		std::string text;
+
+		while (!data.empty()) {
+			char tag;
+			uint16_t id;
+			uint32_t length;
+			readValue(data, tag);
+
+			if (tag == 'F') {
+				if (!readValue(data, id) || !readValue(data, length) || data.size() < length || id >= formats.size()) { break; }
+				formats[id].assign(data.data(), length);
+				data.remove_prefix(length);
+			} else if (tag == 'M') {
+				int64_t time;
+				uint8_t level;
+				uint8_t category;
+				if (!readValue(data, time) || !readValue(data, id) || !readValue(data, level) || !readValue(data, category)) { break; }
+				if (!readValue(data, length) || data.size() < length || id >= formats.size()) { break; }
+				appendLogLine(text, timestamp, time, static_cast<LogLevel>(level), static_cast<LogCategory>(category), formats[id], data.substr(0, length));
+				data.remove_prefix(length);
+			} else {
+				// Anything else means the file was cut off mid record, keep what decoded cleanly
+				break;
+			}
+		}
+
+		std::ofstream output(outputName, std::ios::out | std::ios::trunc | std::ios::binary);
+		output.write(text.data(), text.size());
+		return true;
+	}
+}
\ No newline at end of file
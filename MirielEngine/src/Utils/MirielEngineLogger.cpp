@@ -5,51 +5,327 @@
 #include <ctime>
 #include <filesystem>
 #include <fstream>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include "Utils/LogCompressor.hpp"
+
+#if _WIN64
+#define NOMINMAX
+#include <windows.h>
+#elif __APPLE__
+#include <pthread.h>
+#else
+#include <sys/resource.h>
+#endif
 
 namespace MirielEngine::Utils {
-	void LoggingThreadFunction (std::shared_ptr<DataStructures::ThreadsafeQueue<std::unique_ptr<LoggingMessage>>> msgBuffer, const std::string& filename) {
-		MirielEngine::Utils::GlobalLogger->log("Within Thread: Making Logging File.");
-		std::ofstream file(filename, std::ios::out | std::ios::app | std::ios::binary);
-
-		if (file.fail() || file.bad()) {
-			std::ostringstream out;
-			out << "Failed to Open File for Logging:\nThread ID: " << std::this_thread::get_id() << " Within " << __FILE__ << " at Line: " << __LINE__;
-			out << "\nFile Fail: " << file.fail() << "\nFile Bad: " << file.bad() << "\nFile is Open: " << file.is_open();
-			out << "\nFile Name: " << filename;
-			throw MirielEngine::Errors::LoggingError(out.str().c_str());
+	char* LoggingMessage::reserve(size_t size) {
+		length = size;
+		if (length <= inlineSize) {
+			return inlineArgs;
+		}
+		overflow.resize(length);
+		return overflow.data();
+	}
+
+	std::string_view LoggingMessage::args() const {
+		if (length <= inlineSize) {
+			return std::string_view(inlineArgs, length);
 		}
+		return std::string_view(overflow.data(), length);
+	}
+
+	void LoggingSignal::notify() {
+		// Pairs with the fence in wait, either this sees the writer asleep or the writer sees the new message
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!writerSleeping.load(std::memory_order_relaxed)) { return; }
+		forceNotify();
+	}
+
+	void LoggingSignal::forceNotify() {
+		epoch.fetch_add(1, std::memory_order_seq_cst);
+		epoch.notify_one();
+	}
+
+	void LoggingSignal::wait(uint32_t seenEpoch, const LoggingBuffer& buffer, const std::atomic<bool>& running) {
+		writerSleeping.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (buffer.empty() && running.load()) {
+			epoch.wait(seenEpoch, std::memory_order_acquire);
+		}
+
+		writerSleeping.store(false, std::memory_order_relaxed);
+	}
 
-		auto LoggingLoop = [&](size_t minNum, size_t maxNum) {
-			if (msgBuffer->size() < minNum) { return; }
+	void LoggingThreadFunction (std::shared_ptr<LoggingBuffer> msgBuffer, std::shared_ptr<LoggingSignal> signal, const std::string& filename) {
+		// GlobalLogger may not be assigned yet while the constructor is still running, getInstance waits on the lock instead
+		Logger* logger = Logger::getInstance();
+		logger->log("Within Thread: Making Logging File.");
+		std::ofstream file;
 
-			for (int i = 0; i < std::min(maxNum, msgBuffer->size()); i++) {
-				std::unique_ptr<LoggingMessage> curr = std::move(msgBuffer->front());
-				msgBuffer->pop();
+		LoggingStats& stats = logger->getStats();
 
+		// Rotated segments are handed over by name, compressing them here would stall the batches behind it
+		DataStructures::ThreadsafeQueue<std::string> rotatedSegments;
+		std::thread compressionThread(LogCompressionThreadFunction, std::ref(rotatedSegments), std::cref(filename), std::ref(stats));
+
+		// Whole batch is formatted into one buffer so each batch is a single write
+		std::string batch;
+		batch.reserve(64 * 1024);
+
+		int64_t oldestInBatch = 0;
+
+		uint64_t segmentBytes = 0;
+		uint64_t segmentPart = 0;
+		std::chrono::steady_clock::time_point segmentOpened;
+		std::chrono::steady_clock::duration segmentWriteTime{ 0 };
+
+#if MIRIEL_BINARY_LOGGING
+		// Format strings are written into each segment the first time each ID is used, so every segment decodes on its own
+		std::vector<bool> formatWritten(LogFormatRegistry::maxFormats, false);
+
+		auto AppendValue = [&](const auto& value) {
+			batch.append(reinterpret_cast<const char*>(&value), sizeof(value));
+		};
+#else
+		LogTimestampFormatter timestamp;
+#endif
+
+		auto OpenSegment = [&]() {
+			file.open(filename, std::ios::out | std::ios::app | std::ios::binary);
+
+			if (file.fail() || file.bad()) {
 				std::ostringstream out;
-				std::time_t currTime = std::chrono::system_clock::to_time_t(curr->time);
-				tm convertedCurrTime;
-				localtime_s(&convertedCurrTime, &currTime);
-				out << std::put_time(&convertedCurrTime, "%H:%M:%S: ") << curr->msg << "\n";
+				out << "Failed to Open File for Logging:\nThread ID: " << std::this_thread::get_id() << " Within " << __FILE__ << " at Line: " << __LINE__;
+				out << "\nFile Fail: " << file.fail() << "\nFile Bad: " << file.bad() << "\nFile is Open: " << file.is_open();
+				out << "\nFile Name: " << filename;
+				throw MirielEngine::Errors::LoggingError(out.str().c_str());
+			}
+
+			segmentBytes = 0;
+			segmentOpened = std::chrono::steady_clock::now();
+			segmentWriteTime = std::chrono::steady_clock::duration::zero();
+			stats.segmentBytesWritten.store(0, std::memory_order_relaxed);
+
+#if MIRIEL_BINARY_LOGGING
+			std::fill(formatWritten.begin(), formatWritten.end(), false);
+			file.write(binaryLogMagic, sizeof(binaryLogMagic));
+			file.write(reinterpret_cast<const char*>(&binaryLogVersion), sizeof(binaryLogVersion));
+#endif
+		};
+
+		auto SegmentThroughput = [&]() {
+			double seconds = std::chrono::duration<double>(segmentWriteTime).count();
+			return seconds > 0.0 ? (segmentBytes / (1024.0 * 1024.0)) / seconds : 0.0;
+		};
 
-				file << out.str().c_str();
+		auto RotateSegment = [&]() {
+			file.close();
+
+			std::filesystem::path segmentName(filename);
+			segmentName.replace_filename(segmentName.stem().string() + " - part " + std::to_string(++segmentPart) + segmentName.extension().string());
+
+			std::error_code ec;
+			std::filesystem::rename(filename, segmentName, ec);
+			if (!ec) { rotatedSegments.push(segmentName.string()); }
+
+			double throughput = SegmentThroughput();
+			uint64_t closedBytes = segmentBytes;
+			stats.segmentsRotated.fetch_add(1, std::memory_order_relaxed);
+			stats.lastSegmentMegabytesPerSecond.store(throughput, std::memory_order_relaxed);
+
+			OpenSegment();
+			MIRIEL_LOG(Info, Core, "Within Thread: Rotated Log Segment {} After {} Bytes, Written at {} MB/s.", segmentName.filename().string(), closedBytes, throughput);
+		};
+
+		OpenSegment();
+
+		auto WriteMessage = [&](LoggingMessage& curr) {
+			if (batch.empty() || curr.time < oldestInBatch) { oldestInBatch = curr.time; }
+			std::string_view args = curr.args();
+
+#if MIRIEL_BINARY_LOGGING
+			if (!formatWritten[curr.formatID]) {
+				std::string_view fmt = LogFormatRegistry::getFormat(curr.formatID);
+				batch.push_back('F');
+				AppendValue(curr.formatID);
+				AppendValue(static_cast<uint32_t>(fmt.size()));
+				batch.append(fmt);
+				formatWritten[curr.formatID] = true;
 			}
 
+			batch.push_back('M');
+			AppendValue(curr.time);
+			AppendValue(curr.formatID);
+			AppendValue(curr.level);
+			AppendValue(curr.category);
+			AppendValue(static_cast<uint32_t>(args.size()));
+			batch.append(args);
+#else
+			appendLogLine(batch, timestamp, curr.time, curr.level, curr.category, LogFormatRegistry::getFormat(curr.formatID), args);
+#endif
+		};
+
+		// Written straight into the batch rather than queued, the queue is exactly what is full when this matters
+		LoggingMessage dropNotice;
+		dropNotice.formatID = MIRIEL_LOG_FORMAT_ID("Logger Dropped {} Messages Under Backpressure ({} Total).");
+		dropNotice.level = LogLevel::Warning;
+		dropNotice.category = LogCategory::Core;
+
+		// Same for the shutdown lines, programRunning is already false by then and pushMessage would only drop them
+		LoggingMessage shutdownNotice;
+		shutdownNotice.formatID = LogFormatRegistry::plainMessageID;
+		shutdownNotice.level = LogLevel::Info;
+		shutdownNotice.category = LogCategory::Core;
+		size_t pendingNotices = 0;
+
+		auto WriteNotice = [&](std::string_view text) {
+			shutdownNotice.time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+			encodeArgument(shutdownNotice.reserve(encodedArgumentSize(text)), text);
+			WriteMessage(shutdownNotice);
+			pendingNotices++;
+		};
+
+		auto LoggingLoop = [&]() {
+			// Takes everything that is ready in one go, capped at the capacity so a flood of producers can't keep us here forever
+			size_t count = pendingNotices;
+			pendingNotices = 0;
+			size_t maxNum = msgBuffer->capacity();
+			while (count < maxNum && msgBuffer->tryPop(WriteMessage)) { count++; }
+
+			uint64_t dropped = stats.droppedUnreported.exchange(0, std::memory_order_relaxed);
+			if (dropped > 0) {
+				uint64_t totalDropped = stats.messagesDropped.load(std::memory_order_relaxed);
+				dropNotice.time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+				char* out = dropNotice.reserve(encodedArgumentSize(dropped) + encodedArgumentSize(totalDropped));
+				encodeArgument(encodeArgument(out, dropped), totalDropped);
+				WriteMessage(dropNotice);
+				count++;
+			}
+
+			if (count == 0) { return false; }
+
+			auto writeStart = std::chrono::steady_clock::now();
+			file.write(batch.data(), batch.size());
 			file.flush();
+			auto writeEnd = std::chrono::steady_clock::now();
+
+			segmentWriteTime += writeEnd - writeStart;
+			segmentBytes += batch.size();
+			stats.segmentBytesWritten.store(segmentBytes, std::memory_order_relaxed);
+			stats.segmentMegabytesPerSecond.store(SegmentThroughput(), std::memory_order_relaxed);
+
+			int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+			int64_t latency = (now - oldestInBatch) / 1000;
+			stats.messagesWritten.fetch_add(count, std::memory_order_relaxed);
+			stats.batchesWritten.fetch_add(1, std::memory_order_relaxed);
+			if (count > stats.largestBatch.load(std::memory_order_relaxed)) { stats.largestBatch.store(count, std::memory_order_relaxed); }
+			if (latency > stats.worstLatencyMicroseconds.load(std::memory_order_relaxed)) { stats.worstLatencyMicroseconds.store(latency, std::memory_order_relaxed); }
+
+			batch.clear();
+
+			if (segmentBytes >= logSegmentMaxBytes || writeEnd - segmentOpened >= std::chrono::seconds(logSegmentMaxSeconds)) {
+				RotateSegment();
+			}
+			return true;
 		};
 
-		while (MirielEngine::Utils::GlobalLogger->getProgramRunning() || !msgBuffer->empty()) {
-			LoggingLoop(1, 32);
-			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		const std::atomic<bool>& running = logger->getProgramRunningFlag();
+
+		while (running.load() || !msgBuffer->empty()) {
+			uint32_t seenEpoch = signal->epoch.load(std::memory_order_seq_cst);
+			if (!LoggingLoop()) {
+				signal->wait(seenEpoch, *msgBuffer, running);
+			}
 		}
 
-		MirielEngine::Utils::GlobalLogger->log("Within Thread: Application Finished, Finishing Logging.");
-		size_t remaining = msgBuffer->size();
+		WriteNotice("Within Thread: Application Finished, Finishing Logging.");
 
-		LoggingLoop(1, remaining);
+		// A producer that saw the logger running can still be pushing, the final drain has to come after it
+		logger->waitForProducers();
+		while (LoggingLoop()) {}
 
-		MirielEngine::Utils::GlobalLogger->log("Within Thread: Closing Logging File.");
+		WriteNotice("Within Thread: Closing Logging File.");
+		LoggingLoop();
 		file.close();
+
+		// The last segment stays as plain text, only finished rotations get compressed
+		rotatedSegments.close();
+		compressionThread.join();
+	}
+
+	void LogCompressionThreadFunction(DataStructures::ThreadsafeQueue<std::string>& segments, const std::string& activeLog, LoggingStats& stats) {
+		// Compression should only ever use time the rest of the engine doesn't want
+#if _WIN64
+		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif __APPLE__
+		pthread_set_qos_class_self_np(QOS_CLASS_BACKGROUND, 0);
+#else
+		// On Linux a zero id means the calling thread rather than the whole process
+		setpriority(PRIO_PROCESS, 0, 19);
+#endif
+
+		// Clears out whatever earlier runs left over the limits before anything new is written
+		enforceLogRetention(activeLog);
+
+		std::vector<std::string> pending;
+		while (segments.wait_drain_into(pending) > 0) {
+			for (const std::string& segment : pending) {
+				if (compressLogFile(segment) > 0) {
+					stats.segmentsCompressed.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+			pending.clear();
+			enforceLogRetention(activeLog);
+		}
+	}
+
+	void enforceLogRetention(const std::string& activeLog) {
+		struct LogFileInfo {
+			std::filesystem::path path;
+			std::filesystem::file_time_type time;
+			uint64_t size;
+		};
+
+		std::error_code ec;
+		std::filesystem::path activePath(activeLog);
+		std::filesystem::path ringPath(getMappedRingFileName());
+
+		std::vector<LogFileInfo> files;
+		uint64_t totalBytes = 0;
+		for (const auto& entry : std::filesystem::directory_iterator(activePath.parent_path(), ec)) {
+			if (!entry.is_regular_file(ec)) { continue; }
+			if (std::filesystem::equivalent(entry.path(), activePath, ec) || std::filesystem::equivalent(entry.path(), ringPath, ec)) { continue; }
+
+			LogFileInfo info{ entry.path(), entry.last_write_time(ec), entry.file_size(ec) };
+			totalBytes += info.size;
+			files.push_back(std::move(info));
+		}
+
+		std::sort(files.begin(), files.end(), [](const LogFileInfo& a, const LogFileInfo& b) { return a.time < b.time; });
+
+		size_t remaining = files.size();
+		for (const LogFileInfo& info : files) {
+			if (remaining <= logRetainedFiles && totalBytes <= logRetainedBytes) { break; }
+			if (std::filesystem::remove(info.path, ec)) {
+				totalBytes -= info.size;
+				remaining--;
+			}
+		}
+	}
+
+	const char* getLogBackpressurePolicyName(LogBackpressurePolicy policy) {
+		switch (policy) {
+			using enum LogBackpressurePolicy;
+			case Block: return "Block";
+			case DropNewest: return "Drop Newest";
+			case DropOldest: return "Drop Oldest";
+			case Sample: return "Sample";
+			default: return "Unknown";
+		}
 	}
 
 	std::string createLoggingFileName() {
@@ -57,25 +333,119 @@ namespace MirielEngine::Utils {
 		std::time_t currTime = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
 		tm convertedCurrTime;
 		localtime_s(&convertedCurrTime, &currTime);
-		os << std::filesystem::current_path().string() << "/Logs/log - " << std::put_time(&convertedCurrTime, "%b-%d-%Y - %H-%M-%S") << ".log";
+		os << std::filesystem::current_path().string() << "/Logs/log - " << std::put_time(&convertedCurrTime, "%b-%d-%Y - %H-%M-%S") << (MIRIEL_BINARY_LOGGING ? ".mlog" : ".log");
 		return os.str();
 	}
 
+	std::string getMappedRingFileName() {
+		return std::filesystem::current_path().string() + "/Logs/active.mring";
+	}
+
 	Logger::Logger() {
 		programRunning = true;
-		msgQueue = std::make_shared<DataStructures::ThreadsafeQueue<std::unique_ptr<LoggingMessage>>>();
+		runtimeLevel = MIRIEL_LOG_MIN_LEVEL;
+		runtimeCategories = MIRIEL_LOG_CATEGORIES;
+		backpressurePolicy = MIRIEL_LOG_BACKPRESSURE;
+		sampleRate = MIRIEL_LOG_SAMPLE_RATE;
+		msgQueue = std::make_shared<LoggingBuffer>(queueCapacity);
+		msgSignal = std::make_shared<LoggingSignal>();
+
+#if MIRIEL_MAPPED_LOGGING
+		// Runs before main, so checkLoggingDir hasn't made the directory yet
+		std::error_code ec;
+		std::filesystem::create_directories(std::filesystem::current_path() / "Logs", ec);
+
+		// A ring still on disk means the last run never reached cleanup, turn it into a normal log before reusing the file
+		std::string ringName = getMappedRingFileName();
+		if (std::filesystem::exists(ringName, ec)) {
+			std::filesystem::path recoveredName = std::filesystem::path(currentLog).replace_extension(".log");
+			recoveredName.replace_filename("recovered " + recoveredName.filename().string());
+			MappedLogRing::recover(ringName, recoveredName.string());
+		}
 
-		loggingThread = std::thread(LoggingThreadFunction, msgQueue, currentLog);
+		mappedRing = std::make_unique<MappedLogRing>();
+		if (mappedRing->create(ringName)) {
+			return;
+		}
+		mappedRing.reset();
+#endif
+
+		loggingThread = std::thread(LoggingThreadFunction, msgQueue, msgSignal, currentLog);
 	}
 
 	Logger::~Logger() = default;
 
-	void Logger::log(const std::string& msg) {
-		auto lgMsg = std::make_unique<LoggingMessage>();
-		lgMsg->msg = msg;
-		lgMsg->time = std::chrono::system_clock::now();
+	void Logger::log(std::string_view msg) {
+		if (!shouldLog(LogLevel::Info, LogCategory::Core)) { return; }
+		logFormat(LogFormatRegistry::plainMessageID, LogLevel::Info, LogCategory::Core, "{}", msg);
+	}
+
+	void Logger::setRuntimeLevel(LogLevel level) {
+		runtimeLevel.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+	}
+
+	LogLevel Logger::getRuntimeLevel() const {
+		return static_cast<LogLevel>(runtimeLevel.load(std::memory_order_relaxed));
+	}
+
+	void Logger::setRuntimeCategoryEnabled(LogCategory category, bool enabled) {
+		if (enabled) {
+			runtimeCategories.fetch_or(static_cast<uint8_t>(category), std::memory_order_relaxed);
+		} else {
+			runtimeCategories.fetch_and(static_cast<uint8_t>(~static_cast<uint8_t>(category)), std::memory_order_relaxed);
+		}
+	}
+
+	bool Logger::getRuntimeCategoryEnabled(LogCategory category) const {
+		return (runtimeCategories.load(std::memory_order_relaxed) & static_cast<uint8_t>(category)) != 0;
+	}
+
+	void Logger::setBackpressurePolicy(LogBackpressurePolicy policy) {
+		backpressurePolicy.store(static_cast<uint8_t>(policy), std::memory_order_relaxed);
+	}
 
-		msgQueue->push(std::move(lgMsg));
+	LogBackpressurePolicy Logger::getBackpressurePolicy() const {
+		return static_cast<LogBackpressurePolicy>(backpressurePolicy.load(std::memory_order_relaxed));
+	}
+
+	void Logger::setSampleRate(uint32_t rate) {
+		sampleRate.store(rate == 0 ? 1 : rate, std::memory_order_relaxed);
+	}
+
+	uint32_t Logger::getSampleRate() const {
+		return sampleRate.load(std::memory_order_relaxed);
+	}
+
+	bool Logger::handleFullQueue(bool firstAttempt) {
+		switch (getBackpressurePolicy()) {
+			using enum LogBackpressurePolicy;
+			case DropNewest:
+				return false;
+			case DropOldest:
+				// Races the logging thread for the oldest slot, if it wins there is room now anyway
+				if (msgQueue->tryPop([](LoggingMessage&) {})) { recordDrop(); }
+				return true;
+			case Sample:
+				if (firstAttempt && sampleCounter.fetch_add(1, std::memory_order_relaxed) % getSampleRate() != 0) { return false; }
+				[[fallthrough]];
+			case Block:
+			default:
+				if (firstAttempt) { stats.messagesBlocked.fetch_add(1, std::memory_order_relaxed); }
+				return waitForRoom();
+		}
+	}
+
+	void Logger::recordDrop() {
+		stats.messagesDropped.fetch_add(1, std::memory_order_relaxed);
+		stats.droppedUnreported.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	bool Logger::waitForRoom() {
+		// The logging thread is the only consumer, it can't wait on itself to make room
+		if (std::this_thread::get_id() == loggingThread.get_id()) { return false; }
+		msgSignal->notify();
+		std::this_thread::yield();
+		return true;
 	}
 
 	Logger* Logger::getInstance() {
@@ -96,8 +466,37 @@ namespace MirielEngine::Utils {
 		return programRunning;
 	}
 
+	const std::atomic<bool>& Logger::getProgramRunningFlag() {
+		return programRunning;
+	}
+
+	LoggingStats& Logger::getStats() {
+		return stats;
+	}
+
+	void Logger::waitForProducers() {
+		while (activeProducers.load(std::memory_order_acquire) != 0) {
+			std::this_thread::yield();
+		}
+	}
+
 	void Logger::cleanup() {
-		programRunning = false;
+		// main's error path cleans up and then falls through to the normal shutdown, the second call has nothing left to do
+		if (!programRunning.exchange(false, std::memory_order_seq_cst)) { return; }
+
+		if (mappedRing) {
+			// Producers write into the mapping directly, once the last one is out the ring holds its last MIRIEL_MAPPED_LOG_SLOTS records
+			waitForProducers();
+			mappedRing->close();
+			std::string ringName = getMappedRingFileName();
+			MappedLogRing::recover(ringName, std::filesystem::path(currentLog).replace_extension(".log").string());
+			std::error_code ec;
+			std::filesystem::remove(ringName, ec);
+			enforceLogRetention(currentLog);
+			return;
+		}
+
+		msgSignal->forceNotify();
 		loggingThread.join();
 	}
 }
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "Utils/MonotonicArena.hpp"
+
+namespace MirielEngine::Utils {
+	void* MonotonicArena::BlockResource::do_allocate(size_t bytes, size_t alignment) {
+		void* block = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		// Only the arena calls this, always with its lock held
+		size_t reserved = reservedBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+		if (reserved > peakReservedBytes.load(std::memory_order_relaxed)) {
+			peakReservedBytes.store(reserved, std::memory_order_relaxed);
+		}
+		return block;
+	}
+
+	void MonotonicArena::BlockResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		reservedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+	}
+
+	bool MonotonicArena::BlockResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+		return this == &other;
+	}
+
+	MonotonicArena::MonotonicArena() : blocks(MIRIEL_SCENE_ARENA_BLOCK_BYTES, &blockResource) {}
+
+	void* MonotonicArena::do_allocate(size_t bytes, size_t alignment) {
+		std::scoped_lock<std::mutex> lock(arenaMtx);
+		usedBytes.fetch_add(bytes, std::memory_order_relaxed);
+		return blocks.allocate(bytes, alignment);
+	}
+
+	void MonotonicArena::do_deallocate(void*, size_t, size_t) {}
+
+	bool MonotonicArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+		return this == &other;
+	}
+
+	void MonotonicArena::release() {
+		std::scoped_lock<std::mutex> lock(arenaMtx);
+		blocks.release();
+		usedBytes.store(0, std::memory_order_relaxed);
+	}
+
+	size_t MonotonicArena::getUsedBytes() const {
+		return usedBytes.load(std::memory_order_relaxed);
+	}
+
+	size_t MonotonicArena::getReservedBytes() const {
+		return blockResource.reservedBytes.load(std::memory_order_relaxed);
+	}
+
+	size_t MonotonicArena::getPeakReservedBytes() const {
+		return blockResource.peakReservedBytes.load(std::memory_order_relaxed);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "Utils/StringInterner.hpp"
+
+namespace MirielEngine::Utils {
+	StringInterner::StringInterner() {
+		intern("");
+	}
+
+	StringInterner::~StringInterner() = default;
+
+	StringInterner* StringInterner::getInstance() {
+		if (instance == nullptr) {
+			std::scoped_lock<std::mutex> lock(mtx);
+			if (instance == nullptr) {
+				instance = new StringInterner();
+			}
+		}
+		return instance;
+	}
+
+	StringID StringInterner::intern(std::string_view string) {
+		{
+			std::shared_lock<std::shared_mutex> lock(stringsMtx);
+			auto existing = ids.find(string);
+			if (existing != ids.end()) { return existing->second; }
+		}
+
+		std::unique_lock<std::shared_mutex> lock(stringsMtx);
+		// Someone else could have added it between the two locks
+		auto existing = ids.find(string);
+		if (existing != ids.end()) { return existing->second; }
+
+		StringID id = static_cast<StringID>(strings.size());
+		strings.emplace_back(string);
+		ids.emplace(strings.back(), id);
+		return id;
+	}
+
+	const std::string& StringInterner::get(StringID id) const {
+		std::shared_lock<std::shared_mutex> lock(stringsMtx);
+		return strings[id];
+	}
+
+	size_t StringInterner::size() const {
+		std::shared_lock<std::shared_mutex> lock(stringsMtx);
+		return strings.size();
+	}
+}
\ No newline at end of file